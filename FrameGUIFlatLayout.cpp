@@ -0,0 +1,402 @@
+#include "FrameGUIFlatLayout.h"
+
+namespace FrameGUILayout {
+
+	FlatLayoutTree::FlatLayoutTree(const CustomLayoutNode* root) {
+		assert(root != nullptr && "Root must not be null");
+		AppendSubtree(-1, root);
+	}
+
+	void FlatLayoutTree::AppendSubtree(int parent, const CustomLayoutNode* node) {
+		assert(node->GetKind() == LayoutNode_Split && "Only splitters and window nodes are supported by FlatLayoutTree");
+		int idx = node->IsWindowNode()
+			? AddWindow(parent, node->GetWindowFunc(), node->GetLabel().c_str())
+			: AddSplitter(parent, node->IsVerticalSplitter(), node->GetLabel().c_str());
+		if (!node->IsVisibleFlag()) m_flags[idx] &= ~NodeFlags_Visible;
+		if (!node->m_equalizeOnVisibleChange) m_flags[idx] &= ~NodeFlags_Equalize;
+		m_constraints[idx] = node->GetConstraints();
+
+		const auto& children = node->GetChildren();
+		for (int i = 0; i < (int)children.size(); ++i) {
+			if (!children[i]) continue;
+			int before = NodeCount();
+			AppendSubtree(idx, children[i]);
+			m_ratio[before] = node->GetSplitRatio(i);
+		}
+		// AddNode reset it for every appended child
+		m_lastVisibleCount[idx] = (int)node->m_lastVisibleCount;
+	}
+
+	void FlatLayoutTree::Reserve(int nodeCount) {
+		m_flags.reserve(nodeCount);
+		m_parent.reserve(nodeCount);
+		m_firstChild.reserve(nodeCount);
+		m_lastChild.reserve(nodeCount);
+		m_nextSibling.reserve(nodeCount);
+		m_visibleCount.reserve(nodeCount);
+		m_lastVisibleCount.reserve(nodeCount);
+		m_ratio.reserve(nodeCount);
+		m_offset.reserve(nodeCount);
+		m_constraints.reserve(nodeCount);
+		m_domainPos.reserve(nodeCount);
+		m_domainSize.reserve(nodeCount);
+		m_func.reserve(nodeCount);
+		m_label.reserve(nodeCount);
+		m_prepareJob.reserve(nodeCount);
+	}
+
+	int FlatLayoutTree::AddNode(int parent, uint8_t flags, PaneCallable func, const char* label) {
+		assert((parent == -1) == m_flags.empty() && "Only the first node may be the root");
+		assert((parent < 0 || !HasFlag(parent, NodeFlags_Window)) && "Window nodes cannot have children");
+		const int idx = NodeCount();
+		m_flags.push_back(flags | NodeFlags_Visible);
+		m_parent.push_back(parent);
+		m_firstChild.push_back(-1);
+		m_lastChild.push_back(-1);
+		m_nextSibling.push_back(-1);
+		m_visibleCount.push_back(0);
+		m_lastVisibleCount.push_back(0);
+		m_ratio.push_back(0.f);
+		m_offset.push_back(0.f);
+		m_constraints.push_back(LayoutConstraints());
+		m_domainPos.push_back(ImVec2(0, 0));
+		m_domainSize.push_back(ImVec2(0, 0));
+		m_func.push_back(std::move(func));
+		m_label.push_back(label);
+		m_prepareJob.push_back(-1);
+
+		if (parent >= 0) {
+			if (m_lastChild[parent] < 0) m_firstChild[parent] = idx;
+			else m_nextSibling[m_lastChild[parent]] = idx;
+			m_lastChild[parent] = idx;
+			m_lastVisibleCount[parent] = 0;
+		}
+		m_visibilityDirty = true;
+		m_geometryDirty = true;
+		return idx;
+	}
+
+	int FlatLayoutTree::AddSplitter(int parent, bool isVertical, const char* label) {
+		return AddNode(parent, NodeFlags_Equalize | (isVertical ? NodeFlags_Vertical : 0), nullptr,
+			label ? label : (isVertical ? "Vertical" : "Horizontal"));
+	}
+
+	int FlatLayoutTree::AddWindow(int parent, PaneCallable func, const char* label) {
+		assert(func && "Window nodes need a window function");
+		return AddNode(parent, NodeFlags_Window, std::move(func), label ? label : "Window");
+	}
+
+	int FlatLayoutTree::NodeCount() const { return (int)m_flags.size(); }
+	int FlatLayoutTree::GetParent(int node) const { return m_parent[node]; }
+	int FlatLayoutTree::GetFirstChild(int node) const { return m_firstChild[node]; }
+	int FlatLayoutTree::GetNextSibling(int node) const { return m_nextSibling[node]; }
+	const std::string& FlatLayoutTree::GetLabel(int node) const { return m_label[node]; }
+
+	void FlatLayoutTree::SetVisible(int node, bool v) {
+		if (HasFlag(node, NodeFlags_Visible) == v) return;
+		if (v) m_flags[node] |= NodeFlags_Visible; else m_flags[node] &= ~NodeFlags_Visible;
+		m_visibilityDirty = true;
+		m_geometryDirty = true;
+	}
+
+	// The parent's constrained flag is rebuilt with the visibility.
+	void FlatLayoutTree::SetSizeConstraints(int node, float minSize, float maxSize) {
+		m_constraints[node].MinSize = ImMax(minSize, 0.f);
+		m_constraints[node].MaxSize = ImMax(maxSize, m_constraints[node].MinSize);
+		m_visibilityDirty = true;
+		m_geometryDirty = true;
+	}
+
+	void FlatLayoutTree::SetFixedSize(int node, float size) {
+		m_constraints[node].FixedSize = ImMax(size, 0.f);
+		m_visibilityDirty = true;
+		m_geometryDirty = true;
+	}
+
+	const LayoutConstraints& FlatLayoutTree::GetConstraints(int node) const { return m_constraints[node]; }
+
+	bool FlatLayoutTree::IsVisibleFlag(int node) const { return HasFlag(node, NodeFlags_Visible); }
+
+	bool FlatLayoutTree::IsEffectivelyVisible(int node) const {
+		if (m_visibilityDirty) return ComputeEffectiveVisibility(node);
+		return HasFlag(node, NodeFlags_EffectiveVisible);
+	}
+
+	bool FlatLayoutTree::ComputeEffectiveVisibility(int node) const {
+		if (!HasFlag(node, NodeFlags_Visible)) return false;
+		if (HasFlag(node, NodeFlags_Window)) return true;
+		for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c])
+			if (ComputeEffectiveVisibility(c)) return true;
+		return false;
+	}
+
+	void FlatLayoutTree::SetDFSVisible(int node, bool new_status) {
+		if (IsWindowNode(node)) return;
+		SetVisible(node, new_status);
+		for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c]) SetVisible(c, new_status);
+	}
+
+	bool FlatLayoutTree::IsWindowNode(int node) const { return HasFlag(node, NodeFlags_Window); }
+	bool FlatLayoutTree::IsVerticalSplitter(int node) const { return !IsWindowNode(node) && HasFlag(node, NodeFlags_Vertical); }
+	ImVec2 FlatLayoutTree::GetDomainPos(int node) const { return m_domainPos[node]; }
+	ImVec2 FlatLayoutTree::GetDomainSize(int node) const { return m_domainSize[node]; }
+
+	// Children always have larger indices than their parent, so a reverse sweep
+	// sees every child before its parent and can count visible children in place.
+	void FlatLayoutTree::RefreshVisibility() {
+		const int n = NodeCount();
+		std::fill(m_visibleCount.begin(), m_visibleCount.end(), 0);
+		for (int i = n - 1; i >= 0; --i) {
+			bool eff = HasFlag(i, NodeFlags_Visible) && (HasFlag(i, NodeFlags_Window) || m_visibleCount[i] > 0);
+			if (eff) m_flags[i] |= NodeFlags_EffectiveVisible; else m_flags[i] &= ~NodeFlags_EffectiveVisible;
+			if (eff && m_parent[i] >= 0) ++m_visibleCount[m_parent[i]];
+		}
+		const int widest = n > 0 ? *std::max_element(m_visibleCount.begin(), m_visibleCount.end()) : 0;
+		m_splitChildren.resize(widest + 1);
+		m_splitEdges.resize(widest + 1);
+		m_solverScratch.resize(4 * (widest + 1));
+
+		for (int i = 0; i < n; ++i) {
+			if (HasFlag(i, NodeFlags_Window) || m_visibleCount[i] == m_lastVisibleCount[i]) continue;
+			m_lastVisibleCount[i] = m_visibleCount[i];
+			if (m_visibleCount[i] == 0 || !HasFlag(i, NodeFlags_Equalize)) continue;
+			const float eq = 1.f / (float)m_visibleCount[i];
+			for (int c = m_firstChild[i]; c >= 0; c = m_nextSibling[c])
+				m_ratio[c] = HasFlag(c, NodeFlags_EffectiveVisible) ? eq : 0.f;
+		}
+		for (int i = 0; i < n; ++i)
+			if (!HasFlag(i, NodeFlags_Window) && m_visibleCount[i] > 0) RefreshOffsets(i);
+		m_visibilityDirty = false;
+	}
+
+	float FlatLayoutTree::VisibleRatioSum(int node) {
+		float sum = 0.f;
+		for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c])
+			if (HasFlag(c, NodeFlags_EffectiveVisible)) sum += m_ratio[c];
+		if (sum <= 1e-6f) {
+			const float eq = 1.f / (float)(m_visibleCount[node] > 0 ? m_visibleCount[node] : 1);
+			for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c])
+				if (HasFlag(c, NodeFlags_EffectiveVisible)) m_ratio[c] = eq;
+			sum = 1.f;
+		}
+		return sum;
+	}
+
+	void FlatLayoutTree::Layout(ImVec2 pos, ImVec2 size) {
+		if (m_flags.empty()) return;
+		if (m_visibilityDirty) RefreshVisibility();
+		m_geometryDirty = false;
+
+		m_domainPos[0] = pos; m_domainSize[0] = size;
+		const int n = NodeCount();
+		for (int i = 0; i < n; ++i) {
+			const int parent = m_parent[i];
+			const bool active = HasFlag(i, NodeFlags_EffectiveVisible) && (parent < 0 || HasFlag(parent, NodeFlags_Active));
+			if (active) m_flags[i] |= NodeFlags_Active; else m_flags[i] &= ~NodeFlags_Active;
+			if (!active || HasFlag(i, NodeFlags_Window)) continue;
+			LayoutChildren(i);
+		}
+	}
+
+	// Caches the end offset of every visible child and whether any of them is
+	// constrained, so Layout is one pass per split and a drag moves one offset.
+	void FlatLayoutTree::RefreshOffsets(int node) {
+		const float sum = VisibleRatioSum(node);
+		int* visible = m_splitChildren.data();
+		int n = 0;
+		bool constrained = false;
+		for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c]) {
+			if (!HasFlag(c, NodeFlags_EffectiveVisible)) continue;
+			visible[n++] = c;
+			constrained |= !m_constraints[c].IsDefault();
+		}
+		float* e = m_splitEdges.data();
+		const float* ratio = m_ratio.data();
+		SplitMath::Offsets(n, sum, [ratio, visible](int k) { return ratio[visible[k]]; }, e);
+		for (int k = 0; k < n; ++k) m_offset[visible[k]] = e[k + 1];
+		if (constrained) m_flags[node] |= NodeFlags_Constrained; else m_flags[node] &= ~NodeFlags_Constrained;
+	}
+
+	void FlatLayoutTree::LayoutChildren(int node) {
+		const bool vertical = HasFlag(node, NodeFlags_Vertical);
+		const ImVec2 p = m_domainPos[node], s = m_domainSize[node];
+		const float start = vertical ? p.y : p.x;
+		const float extent = vertical ? s.y : s.x;
+		auto place = [&](int c, float a, float b) {
+			if (vertical) { m_domainPos[c] = ImVec2(p.x, a); m_domainSize[c] = ImVec2(s.x, b - a); }
+			else { m_domainPos[c] = ImVec2(a, p.y); m_domainSize[c] = ImVec2(b - a, s.y); }
+		};
+
+		if (!HasFlag(node, NodeFlags_Constrained)) {
+			float a = start;
+			for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c]) {
+				if (!HasFlag(c, NodeFlags_EffectiveVisible)) continue;
+				const float b = SplitMath::OffsetEdge(start, extent, m_offset[c]);
+				place(c, a, b);
+				a = b;
+			}
+			return;
+		}
+
+		int* visible = m_splitChildren.data();
+		int n = 0;
+		for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c])
+			if (HasFlag(c, NodeFlags_EffectiveVisible)) visible[n++] = c;
+		const float* ratio = m_ratio.data();
+		const LayoutConstraints* limits = m_constraints.data();
+		float* e = m_splitEdges.data();
+		SplitMath::SolveEdges(n, start, extent,
+			[ratio, visible](int k) { return ratio[visible[k]]; },
+			[limits, visible](int k) -> const LayoutConstraints& { return limits[visible[k]]; },
+			e, m_solverScratch.data());
+		for (int k = 0; k < n; ++k) place(visible[k], e[k], e[k + 1]);
+	}
+
+	// The active flags are still those of the last Layout, so the subtree is
+	// swept like Layout does, over its own nodes only.
+	void FlatLayoutTree::LayoutSubtree(int node) {
+		m_geometryDirty = false;
+		m_subtree.clear();
+		m_subtree.push_back(node);
+		for (size_t k = 0; k < m_subtree.size(); ++k)
+			for (int c = m_firstChild[m_subtree[k]]; c >= 0; c = m_nextSibling[c])
+				if (HasFlag(c, NodeFlags_Active) && !HasFlag(c, NodeFlags_Window)) m_subtree.push_back(c);
+		std::sort(m_subtree.begin(), m_subtree.end());
+		for (int i : m_subtree) LayoutChildren(i);
+	}
+
+	bool FlatLayoutTree::IsInSubtree(int root, int node) const {
+		while (node > root) node = m_parent[node];
+		return node == root;
+	}
+
+	void FlatLayoutTree::RenderPanes() const {
+		const int n = NodeCount();
+		for (int i = 0; i < n; ++i) {
+			if (!HasFlag(i, NodeFlags_Window) || !HasFlag(i, NodeFlags_Active)) continue;
+			ImGui::SetNextWindowPos(m_domainPos[i]);
+			ImGui::SetNextWindowSize(m_domainSize[i]);
+			m_func[i]();
+		}
+	}
+
+	void FlatLayoutTree::CollectPrepareJobs(std::vector<PanePrepareJob>& out) {
+		const int n = NodeCount();
+		for (int i = 0; i < n; ++i) {
+			m_prepareJob[i] = -1;
+			if (!HasFlag(i, NodeFlags_Window) || !HasFlag(i, NodeFlags_Active) || !m_func[i].HasPrepare()) continue;
+			const ImVec2 p = m_domainPos[i], s = m_domainSize[i];
+			m_prepareJob[i] = (int)out.size();
+			out.push_back({ &m_func[i], ImRect(p, ImVec2(p.x + s.x, p.y + s.y)) });
+		}
+	}
+
+	void FlatLayoutTree::UpdateSubtreePrepareRects(std::vector<PanePrepareJob>& jobs) const {
+		for (int i : m_subtree) {
+			for (int c = m_firstChild[i]; c >= 0; c = m_nextSibling[c]) {
+				const int job = m_prepareJob[c];
+				if (job < 0) continue;
+				const ImVec2 p = m_domainPos[c], s = m_domainSize[c];
+				jobs[job].rect = ImRect(p, ImVec2(p.x + s.x, p.y + s.y));
+			}
+		}
+	}
+
+	void FlatLayoutTree::RenderSplitters() const {
+		ImDrawList* dl = ImGui::GetForegroundDrawList();
+		const int n = NodeCount();
+		for (int i = 0; i < n; ++i) {
+			if (HasFlag(i, NodeFlags_Window) || !HasFlag(i, NodeFlags_Active) || m_visibleCount[i] < 2) continue;
+			const ImVec2 p = m_domainPos[i], s = m_domainSize[i];
+			int seen = 0;
+			for (int c = m_firstChild[i]; c >= 0 && seen < m_visibleCount[i] - 1; c = m_nextSibling[c]) {
+				if (!HasFlag(c, NodeFlags_EffectiveVisible)) continue;
+				++seen;
+				if (HasFlag(i, NodeFlags_Vertical)) {
+					const float b = m_domainPos[c].y + m_domainSize[c].y;
+					dl->AddLine(ImVec2(p.x, b), ImVec2(p.x + s.x, b), IM_COL32(100, 100, 100, 255), m_splitterWidth);
+				}
+				else {
+					const float b = m_domainPos[c].x + m_domainSize[c].x;
+					dl->AddLine(ImVec2(b, p.y), ImVec2(b, p.y + s.y), IM_COL32(100, 100, 100, 255), m_splitterWidth);
+				}
+			}
+		}
+	}
+
+	bool FlatLayoutTree::FindHoveredSplitter(const ImVec2& mousePos, int& outNode, int& outBoundaryIndex) const {
+		outNode = -1; outBoundaryIndex = -1;
+		const float pad = 8.f;
+		const int n = NodeCount();
+		for (int i = 0; i < n; ++i) {
+			if (HasFlag(i, NodeFlags_Window) || !HasFlag(i, NodeFlags_Active) || m_visibleCount[i] < 2) continue;
+			const ImVec2 p = m_domainPos[i], s = m_domainSize[i];
+			const bool vertical = HasFlag(i, NodeFlags_Vertical);
+			if (vertical ? (mousePos.x < p.x || mousePos.x > p.x + s.x) : (mousePos.y < p.y || mousePos.y > p.y + s.y)) continue;
+			int k = 0;
+			for (int c = m_firstChild[i]; c >= 0 && k < m_visibleCount[i] - 1; c = m_nextSibling[c]) {
+				if (!HasFlag(c, NodeFlags_EffectiveVisible)) continue;
+				const float acc = vertical ? m_domainPos[c].y + m_domainSize[c].y : m_domainPos[c].x + m_domainSize[c].x;
+				const float m = vertical ? mousePos.y : mousePos.x;
+				if (m >= acc - pad && m <= acc + pad) { outNode = i; outBoundaryIndex = k; return true; }
+				++k;
+			}
+		}
+		return false;
+	}
+
+	bool FlatLayoutTree::HandleSplitterDragAt(int node, int boundaryIndex, const ImVec2& mouseDelta) {
+		if (node < 0 || boundaryIndex < 0) return false;
+		if (m_visibilityDirty) RefreshVisibility();
+		if (HasFlag(node, NodeFlags_Window) || !HasFlag(node, NodeFlags_EffectiveVisible)) return false;
+		if (boundaryIndex >= m_visibleCount[node] - 1) return false;
+
+		const bool vertical = HasFlag(node, NodeFlags_Vertical);
+		int iA = -1, iB = -1, k = 0;
+		float startA = 0.f;
+		for (int c = m_firstChild[node]; c >= 0; c = m_nextSibling[c]) {
+			if (!HasFlag(c, NodeFlags_EffectiveVisible)) continue;
+			if (k < boundaryIndex) startA = m_offset[c];
+			else if (k == boundaryIndex) iA = c;
+			else { iB = c; break; }
+			++k;
+		}
+		if (iA < 0 || iB < 0) return false;
+
+		const float sum = VisibleRatioSum(node);
+		const float sizeA = vertical ? m_domainSize[iA].y : m_domainSize[iA].x;
+		const float sizeB = vertical ? m_domainSize[iB].y : m_domainSize[iB].x;
+		if (!SplitMath::DragBoundary(sizeA, sizeA + sizeB, m_constraints[iA], m_constraints[iB],
+			vertical ? mouseDelta.y : mouseDelta.x, m_ratio[iA], m_ratio[iB])) return false;
+		m_offset[iA] = startA + m_ratio[iA] / sum;
+		m_geometryDirty = true;
+		return true;
+	}
+
+	void FlatLayoutTree::CollectSplitters(SplitterIndex& index) const {
+		const int n = NodeCount();
+		for (int i = 0; i < n; ++i) CollectNodeSplitters(i, index);
+	}
+
+	void FlatLayoutTree::CollectSubtreeSplitters(SplitterIndex& index) const {
+		for (int i : m_subtree) CollectNodeSplitters(i, index);
+	}
+
+	void FlatLayoutTree::CollectNodeSplitters(int node, SplitterIndex& index) const {
+		if (HasFlag(node, NodeFlags_Window) || !HasFlag(node, NodeFlags_Active) || m_visibleCount[node] < 2) return;
+		const ImVec2 p = m_domainPos[node], s = m_domainSize[node];
+		const bool vertical = HasFlag(node, NodeFlags_Vertical);
+		int k = 0;
+		for (int c = m_firstChild[node]; c >= 0 && k < m_visibleCount[node] - 1; c = m_nextSibling[c]) {
+			if (!HasFlag(c, NodeFlags_EffectiveVisible)) continue;
+			if (vertical)
+				index.Add(true, m_domainPos[c].y + m_domainSize[c].y, p.x, p.x + s.x, k, nullptr, node);
+			else
+				index.Add(false, m_domainPos[c].x + m_domainSize[c].x, p.y, p.y + s.y, k, nullptr, node);
+			++k;
+		}
+	}
+
+	bool FlatLayoutTree::IsGeometryDirty() const { return m_geometryDirty; }
+
+} // namespace FrameGUILayout
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "FrameGUILayout.h"
+#include <cstdint>
+
+namespace FrameGUILayout {
+
+	// Index-based alternative to the CustomLayoutNode tree. Every node attribute
+	// lives in its own contiguous array and nodes are linked by first-child /
+	// next-sibling indices. A node is always appended after its parent, so one
+	// forward sweep over the arrays visits every parent before its children.
+	class FlatLayoutTree {
+	public:
+		FlatLayoutTree() = default;
+		// Each window node gets its own copy of the source pane callable and its
+		// state. Ratios, visible counts and equalisation are carried over, so the
+		// tree lays out like the source.
+		explicit FlatLayoutTree(const CustomLayoutNode* root);
+
+		void Reserve(int nodeCount);
+		int AddSplitter(int parent, bool isVertical, const char* label = nullptr);
+		int AddWindow(int parent, PaneCallable func, const char* label);
+
+		int NodeCount() const;
+		int GetParent(int node) const;
+		int GetFirstChild(int node) const;
+		int GetNextSibling(int node) const;
+		const std::string& GetLabel(int node) const;
+
+		void SetVisible(int node, bool v);
+		bool IsVisibleFlag(int node) const;
+		// Pixel limits along the parent's split axis, as on CustomLayoutNode.
+		void SetSizeConstraints(int node, float minSize, float maxSize = FLT_MAX);
+		void SetFixedSize(int node, float size);
+		const LayoutConstraints& GetConstraints(int node) const;
+		bool IsEffectivelyVisible(int node) const;
+		void SetDFSVisible(int node, bool new_status);
+
+		bool IsWindowNode(int node) const;
+		bool IsVerticalSplitter(int node) const;
+		ImVec2 GetDomainPos(int node) const;
+		ImVec2 GetDomainSize(int node) const;
+
+		void Layout(ImVec2 pos, ImVec2 size);
+		// Relays out the subtree under node in its current rect after a drag of
+		// one of its boundaries; visibility must not have changed since Layout.
+		void LayoutSubtree(int node);
+		bool IsInSubtree(int root, int node) const;
+		void RenderPanes() const;
+		void CollectPrepareJobs(std::vector<PanePrepareJob>& out);
+		void RenderSplitters() const;
+		bool FindHoveredSplitter(const ImVec2& mousePos, int& outNode, int& outBoundaryIndex) const;
+		bool HandleSplitterDragAt(int node, int boundaryIndex, const ImVec2& mouseDelta);
+		void CollectSplitters(SplitterIndex& index) const;
+		// Splitters and prepare rects of the subtree last relaid out by LayoutSubtree.
+		void CollectSubtreeSplitters(SplitterIndex& index) const;
+		void UpdateSubtreePrepareRects(std::vector<PanePrepareJob>& jobs) const;
+		bool IsGeometryDirty() const;
+
+	private:
+		enum NodeFlags : uint8_t {
+			NodeFlags_Vertical         = 1 << 0,
+			NodeFlags_Window           = 1 << 1,
+			NodeFlags_Visible          = 1 << 2,
+			NodeFlags_EffectiveVisible = 1 << 3,
+			NodeFlags_Active           = 1 << 4, // effectively visible and every ancestor too
+			NodeFlags_Constrained      = 1 << 5, // a visible child has pixel constraints
+			NodeFlags_Equalize         = 1 << 6, // equal ratios whenever the visible child count changes
+		};
+
+		int AddNode(int parent, uint8_t flags, PaneCallable func, const char* label);
+		void AppendSubtree(int parent, const CustomLayoutNode* node);
+		bool ComputeEffectiveVisibility(int node) const;
+		void RefreshVisibility();
+		float VisibleRatioSum(int node);
+		void RefreshOffsets(int node);
+		void LayoutChildren(int node);
+		void CollectNodeSplitters(int node, SplitterIndex& index) const;
+		bool HasFlag(int node, uint8_t f) const { return (m_flags[node] & f) != 0; }
+
+		std::vector<uint8_t> m_flags;
+		std::vector<int> m_parent;
+		std::vector<int> m_firstChild;
+		std::vector<int> m_lastChild;
+		std::vector<int> m_nextSibling;
+		std::vector<int> m_visibleCount;
+		std::vector<int> m_lastVisibleCount;
+		std::vector<float> m_ratio;         // share of the node inside its parent
+		std::vector<float> m_offset;        // end of the node among its parent's visible children, 0..1
+		std::vector<LayoutConstraints> m_constraints;
+		std::vector<ImVec2> m_domainPos;
+		std::vector<ImVec2> m_domainSize;
+		std::vector<PaneCallable> m_func;
+		std::vector<std::string> m_label;
+		std::vector<int> m_prepareJob;      // index in the last CollectPrepareJobs, or -1
+		std::vector<int> m_subtree;         // nodes of the last LayoutSubtree, in index order
+		std::vector<int> m_splitChildren;   // LayoutChildren scratch sized for the widest split: visible children, their edges
+		std::vector<float> m_splitEdges;
+		std::vector<float> m_solverScratch;
+
+		float m_splitterWidth = 1.0f;
+		bool m_visibilityDirty = true;
+		bool m_geometryDirty = true;
+	};
+
+} // namespace FrameGUILayout
@@ -1,6 +1,12 @@
 
 
 #include "FrameGUILayout.h"
+#include "FrameGUIFlatLayout.h"
+#include "FrameGUILayoutSnapshot.h"
+#include "FrameGUIPaneWorkers.h"
+#include "FrameGUILayoutTreeView.h"
+#include <chrono>
+#include <cstring>
 
 namespace FrameGUILayout {
 
@@ -12,79 +18,280 @@ namespace FrameGUILayout {
 		m_splitterWidth = 1.0f;
 		m_lastVisibleCount = 0;
 		m_equalizeOnVisibleChange = true;
-		m_minRatio = 0.05f;
-		m_pfnCustomWindowFunc = nullptr;
 		m_domainPos = ImVec2(0, 0);
 		m_domainSize = ImVec2(0, 0);
 	}
 
-	CustomLayoutNode::CustomLayoutNode(CustomWindowFunc func, const char* label)
-		: m_isVertical(false), m_label(label ? label : "Window"), m_pfnCustomWindowFunc(func)
+	// Tracks, their solved pixel edges and the visible pieces of the track
+	// boundaries of a grid node.
+	struct CustomLayoutNode::GridState {
+		struct Segment {
+			float pos;
+			float spanMin;
+			float spanMax;
+			int boundaryIndex;
+			bool rowBoundary;
+		};
+		std::vector<GridTrack> columns;
+		std::vector<GridTrack> rows;
+		std::vector<float> colEdges;      // columns + 1 pixel edges
+		std::vector<float> rowEdges;      // rows + 1 pixel edges
+		std::vector<int> cellOwner;       // row-major child index per cell, -1 if empty
+		std::vector<Segment> segments;    // boundary pieces between different cells
+		std::vector<float> scratch;
+	};
+
+	CustomLayoutNode::CustomLayoutNode(LayoutNodeKind kind, const char* label)
+		: m_kind(kind), m_isVertical(kind == LayoutNode_Tabs || kind == LayoutNode_Scroll),
+		m_label(label ? label : (kind == LayoutNode_Tabs ? "Tabs" : kind == LayoutNode_Grid ? "Grid" : kind == LayoutNode_Scroll ? "Scroll" : "Horizontal"))
+	{
+		m_visible = true;
+		m_splitterWidth = kind == LayoutNode_Tabs || kind == LayoutNode_Scroll ? 0.0f : 1.0f;
+		m_lastVisibleCount = 0;
+		m_equalizeOnVisibleChange = kind == LayoutNode_Split;
+		m_domainPos = ImVec2(0, 0);
+		m_domainSize = ImVec2(0, 0);
+		if (kind == LayoutNode_Grid) {
+			m_grid = new GridState();
+			SetGridSize(1, 1);
+		}
+	}
+
+	CustomLayoutNode::CustomLayoutNode(PaneCallable func, const char* label)
+		: m_isVertical(false), m_label(label ? label : "Window"), m_paneFunc(std::move(func))
 	{
 		m_visible = true;
 		m_splitterWidth = 0.0f;
 		m_lastVisibleCount = 0;
 		m_equalizeOnVisibleChange = false;
-		m_minRatio = 0.0f;
 		m_domainPos = ImVec2(0, 0);
 		m_domainSize = ImVec2(0, 0);
 	}
 
 	CustomLayoutNode::~CustomLayoutNode() {
 		for (auto* c : m_children) delete c;
+		delete m_grid;
+	}
+
+	void CustomLayoutNode::AttachChild(CustomLayoutNode* child) {
+		m_children.push_back(child);
+		child->m_parent = this;
+		m_splitRatios.resize(m_children.size(), 0.0f);
+		m_visibleChildren.reserve(m_children.size());
+		m_visibleOffsets.reserve(m_children.size() + 1);
+		m_edges.reserve(m_children.size() + 1);
+		m_solverScratch.reserve(4 * (m_children.size() + 1));
+		MarkStructureChanged();
 	}
 
 	void CustomLayoutNode::AddVerticalChild(CustomLayoutNode* child) {
 		assert(IsVerticalSplitter() && "AddVerticalChild only valid on vertical splitter nodes");
 		if (!child) return;
-		m_children.push_back(child);
-		m_splitRatios.resize(m_children.size(), 0.0f);
+		AttachChild(child);
 		m_lastVisibleCount = 0;
+		MarkVisibilityDirty();
 	}
 
 	void CustomLayoutNode::AddHorizontalChild(CustomLayoutNode* child) {
 		assert(IsHorizontalSplitter() && "AddHorizontalChild only valid on horizontal splitter nodes");
 		if (!child) return;
-		m_children.push_back(child);
-		m_splitRatios.resize(m_children.size(), 0.0f);
+		AttachChild(child);
 		m_lastVisibleCount = 0;
+		MarkVisibilityDirty();
 	}
 
-	void CustomLayoutNode::SetHorizontalChildren(CustomLayoutNode* left, CustomLayoutNode* middle, CustomLayoutNode* right) {
-		assert(IsHorizontalSplitter() && "SetHorizontalChildren only valid on horizontal splitter nodes");
+	// The node owns its children, so the ones not passed again are deleted.
+	void CustomLayoutNode::SetChildren(CustomLayoutNode* const* children, int count) {
+		for (CustomLayoutNode* old : m_children)
+			if (std::find(children, children + count, old) == children + count) delete old;
 		m_children.clear();
-		if (left)   m_children.push_back(left);
-		if (middle) m_children.push_back(middle);
-		if (right)  m_children.push_back(right);
-		assert(m_children.size() <= 3 && "Horizontal nodes support max 3 children");
-		m_splitRatios.resize(m_children.size(), 0.0f);
+		m_splitRatios.clear();
+		m_activeTab = nullptr;
+		m_children.reserve(count);
+		for (int i = 0; i < count; ++i)
+			if (children[i]) AttachChild(children[i]);
 		m_lastVisibleCount = 0;
+		MarkStructureChanged();
+		MarkVisibilityDirty();
+	}
+
+	void CustomLayoutNode::SetHorizontalChildren(std::initializer_list<CustomLayoutNode*> children) {
+		SetHorizontalChildren(children.begin(), (int)children.size());
+	}
+
+	void CustomLayoutNode::SetVerticalChildren(std::initializer_list<CustomLayoutNode*> children) {
+		SetVerticalChildren(children.begin(), (int)children.size());
+	}
+
+	void CustomLayoutNode::SetHorizontalChildren(CustomLayoutNode* const* children, int count) {
+		assert(IsHorizontalSplitter() && "SetHorizontalChildren only valid on horizontal splitter nodes");
+		SetChildren(children, count);
 	}
 
-	void CustomLayoutNode::SetVerticalChildren(CustomLayoutNode* left, CustomLayoutNode* middle, CustomLayoutNode* right) {
+	void CustomLayoutNode::SetVerticalChildren(CustomLayoutNode* const* children, int count) {
 		assert(IsVerticalSplitter() && "SetVerticalChildren only valid on Vertical splitter nodes");
-		m_children.clear();
-		if (left)   m_children.push_back(left);
-		if (middle) m_children.push_back(middle);
-		if (right)  m_children.push_back(right);
-		assert(m_children.size() <= 3 && "Vertical nodes support max 3 children");
-		m_splitRatios.resize(m_children.size(), 0.0f);
+		SetChildren(children, count);
+	}
+
+	CustomLayoutNode* CustomLayoutNode::DetachChild(int childIndex) {
+		assert(childIndex >= 0 && childIndex < (int)m_children.size() && "Child index out of range");
+		CustomLayoutNode* child = m_children[childIndex];
+		m_children.erase(m_children.begin() + childIndex);
+		m_splitRatios.erase(m_splitRatios.begin() + childIndex);
+		if (child) child->m_parent = nullptr;
+		if (child == m_activeTab) m_activeTab = nullptr;
+		MarkStructureChanged();
+		MarkVisibilityDirty();
+		return child;
+	}
+
+	void CustomLayoutNode::InsertChild(int index, CustomLayoutNode* child) {
+		assert(!IsWindowNode() && "Window nodes cannot have children");
+		assert(!m_grid && "Grid children are placed with AddGridCell");
+		assert(child && !child->m_parent && "Detach the child before inserting it");
+		index = ImClamp(index, 0, (int)m_children.size());
+		AttachChild(child);
+		std::rotate(m_children.begin() + index, m_children.end() - 1, m_children.end());
+		std::rotate(m_splitRatios.begin() + index, m_splitRatios.end() - 1, m_splitRatios.end());
 		m_lastVisibleCount = 0;
+		MarkVisibilityDirty();
+	}
+
+	bool CustomLayoutNode::MoveTo(CustomLayoutNode* newParent, int index) {
+		if (!newParent || newParent->IsWindowNode() || newParent->m_grid || IsAncestorOf(newParent)) return false;
+		if (m_parent) {
+			const int from = m_parent->IndexOfChild(this);
+			if (m_parent == newParent) {
+				index = ImClamp(index, 0, (int)newParent->m_children.size());
+				if (from < index) --index;
+				if (from == index) return true;
+			}
+			m_parent->DetachChild(from);
+		}
+		newParent->InsertChild(index, this);
+		return true;
+	}
+
+	int CustomLayoutNode::IndexOfChild(const CustomLayoutNode* child) const {
+		for (int i = 0; i < (int)m_children.size(); ++i) if (m_children[i] == child) return i;
+		return -1;
+	}
+
+	bool CustomLayoutNode::IsAncestorOf(const CustomLayoutNode* node) const {
+		for (; node; node = node->m_parent) if (node == this) return true;
+		return false;
 	}
 
 	const std::string& CustomLayoutNode::GetLabel() const { return m_label; }
-	void CustomLayoutNode::SetLabel(const char* label) { if (label) m_label = label; }
+	void CustomLayoutNode::SetLabel(const char* label) {
+		if (!label) return;
+		m_label = label;
+		MarkStructureChanged();
+	}
 
-	void CustomLayoutNode::SetVisible(bool v) { m_visible = v; }
+	CustomLayoutNode* CustomLayoutNode::GetParent() const { return m_parent; }
+	unsigned int CustomLayoutNode::GetStructureVersion() const { return m_structureVersion; }
+
+	void CustomLayoutNode::MarkStructureChanged() {
+		for (CustomLayoutNode* n = this; n; n = n->m_parent) ++n->m_structureVersion;
+	}
+
+	void CustomLayoutNode::SetVisible(bool v) {
+		if (m_visible == v) return;
+		m_visible = v;
+		MarkVisibilityDirty();
+		// inactive tabs are never refreshed and stay dirty, which would stop the
+		// walk above before it reaches the tab container
+		if (m_parent && m_parent->IsTabContainer()) m_parent->MarkVisibilityDirty();
+	}
 	bool CustomLayoutNode::IsVisibleFlag() const { return m_visible; }
 
 	bool CustomLayoutNode::IsEffectivelyVisible() const {
+		if (m_visibilityDirty) return ComputeEffectiveVisibility();
+		return m_effectiveVisible;
+	}
+
+	bool CustomLayoutNode::ComputeEffectiveVisibility() const {
 		if (!m_visible) return false;
 		if (IsWindowNode()) return true;
+		// the tab bar stays up even when the active tab has nothing to show
+		if (m_kind == LayoutNode_Tabs) return ResolveActiveTab() != nullptr;
 		for (auto* c : m_children) if (c && c->IsEffectivelyVisible()) return true;
 		return false;
 	}
 
+	// A visibility change can flip the effective visibility of every ancestor,
+	// so the flag is raised up to the root. Stops early on already-dirty nodes.
+	void CustomLayoutNode::MarkVisibilityDirty() {
+		for (CustomLayoutNode* n = this; n && !n->m_visibilityDirty; n = n->m_parent) {
+			n->m_visibilityDirty = true;
+			n->m_ratiosDirty = true;
+		}
+		MarkGeometryDirty();
+	}
+
+	// Hidden subtrees are not resized and keep stale flags, so this always walks
+	// to the root instead of stopping at the first dirty ancestor.
+	void CustomLayoutNode::MarkGeometryDirty() {
+		for (CustomLayoutNode* n = this; n; n = n->m_parent) n->m_geometryDirty = true;
+	}
+
+	bool CustomLayoutNode::IsGeometryDirty() const { return m_geometryDirty; }
+
+	void CustomLayoutNode::RefreshVisibility() {
+		if (!m_visibilityDirty) return;
+		m_visibleChildren.clear();
+		if (m_kind == LayoutNode_Tabs) {
+			CustomLayoutNode* active = ResolveActiveTab();
+			if (active != m_activeTab) { m_activeTab = active; m_tabSelectPending = true; }
+			if (active) {
+				active->RefreshVisibility();
+				if (active->m_effectiveVisible) m_visibleChildren.push_back(IndexOfChild(active));
+			}
+			m_effectiveVisible = m_visible && active;
+			m_visibilityDirty = false;
+			m_ratiosDirty = true;
+			return;
+		}
+		for (int i = 0; i < (int)m_children.size(); ++i) {
+			CustomLayoutNode* c = m_children[i];
+			if (!c) continue;
+			c->RefreshVisibility();
+			if (c->m_effectiveVisible) m_visibleChildren.push_back(i);
+		}
+		if (m_grid) RefreshGridCells();
+		m_effectiveVisible = m_visible && (IsWindowNode() || !m_visibleChildren.empty());
+		m_visibilityDirty = false;
+		m_ratiosDirty = true;
+	}
+
+	// Rebuilds the prefix offsets of the visible children from the stored
+	// ratios. Only needed after a visibility or ratio reset; drags move a
+	// single offset in place.
+	void CustomLayoutNode::RefreshOffsets() {
+		if (!m_ratiosDirty) return;
+		float sum = 0.f;
+		bool constrained = false;
+		for (int i : m_visibleChildren) {
+			sum += m_splitRatios[i];
+			constrained |= !m_children[i]->m_constraints.IsDefault();
+		}
+		m_hasConstrainedChild = constrained;
+		if (sum <= 1e-6f && !m_visibleChildren.empty()) {
+			float eq = 1.f / m_visibleChildren.size();
+			for (int i : m_visibleChildren) m_splitRatios[i] = eq;
+			sum = 1.f;
+		}
+		m_visibleRatioSum = sum;
+
+		const int n = (int)m_visibleChildren.size();
+		m_visibleOffsets.resize(n + 1);
+		SplitMath::Offsets(n, sum, [this](int k) { return m_splitRatios[m_visibleChildren[k]]; }, m_visibleOffsets.data());
+		m_ratiosDirty = false;
+	}
+
+	float CustomLayoutNode::BoundaryPos(int boundaryIndex) const { return m_edges[boundaryIndex + 1]; }
+
 	void CustomLayoutNode::SetDFSVisible(bool new_status) {
 		if (IsWindowNode()) return;
 		SetVisible(new_status);
@@ -93,287 +300,1668 @@ namespace FrameGUILayout {
 		}
 	}
 
+	// Pure geometry pass. A subtree whose rect is unchanged and which has no
+	// pending visibility/ratio change is skipped entirely; the flag is cleared
+	// last so equalisation inside the pass does not leave ancestors dirty.
 	void CustomLayoutNode::ResizeNodeAndChildren(ImVec2 newPos, ImVec2 newSize) {
+		if (!m_geometryDirty &&
+			newPos.x == m_domainPos.x && newPos.y == m_domainPos.y &&
+			newSize.x == m_domainSize.x && newSize.y == m_domainSize.y) return;
+
 		m_domainPos = newPos; m_domainSize = newSize;
-		if (!IsEffectivelyVisible()) return;
+		RefreshVisibility();
+		if (!m_effectiveVisible || IsWindowNode()) { m_geometryDirty = false; return; }
 
-		if (IsWindowNode()) {
-			ImGui::SetNextWindowPos(m_domainPos);
-			ImGui::SetNextWindowSize(m_domainSize);
-			if (m_pfnCustomWindowFunc) m_pfnCustomWindowFunc();
+		if (m_kind == LayoutNode_Tabs) {
+			// content below the tab bar; m_edges spans it so hit-tests descend as
+			// into a single-child vertical split
+			m_tabBarHeight = ImMin(ImGui::GetFrameHeight(), m_domainSize.y);
+			const float top = m_domainPos.y + m_tabBarHeight;
+			m_edges.resize(m_visibleChildren.size() + 1, top);
+			m_edges.front() = top;
+			m_edges.back() = m_domainPos.y + m_domainSize.y;
+			if (!m_visibleChildren.empty())
+				m_children[m_visibleChildren[0]]->ResizeNodeAndChildren(ImVec2(m_domainPos.x, top), ImVec2(m_domainSize.x, m_domainSize.y - m_tabBarHeight));
+			m_geometryDirty = false;
+			return;
+		}
+
+		if (m_grid) {
+			ResizeGrid();
+			m_geometryDirty = false;
 			return;
 		}
 
 		EqualizeIfVisibleCountChanged();
+		if (m_visibleChildren.empty()) { m_geometryDirty = false; return; }
+		if (m_kind == LayoutNode_Scroll) {
+			ResizeScroll();
+			m_geometryDirty = false;
+			return;
+		}
 
-		std::vector<int> visIdx;
-		visIdx.reserve(m_children.size());
-		for (int i = 0; i < (int)m_children.size(); ++i)
-			if (m_children[i] && m_children[i]->IsEffectivelyVisible()) visIdx.push_back(i);
-		if (visIdx.empty()) return;
+		// Without constraints moving one boundary leaves every other child's
+		// rect bit-identical and its subtree skipped.
+		RefreshOffsets();
+		const int n = (int)m_visibleChildren.size();
+		const float start = m_isVertical ? m_domainPos.y : m_domainPos.x;
+		const float extent = m_isVertical ? m_domainSize.y : m_domainSize.x;
+		m_edges.resize(n + 1);
+		if (m_hasConstrainedChild) {
+			m_solverScratch.resize(4 * (n + 1));
+			SplitMath::SolveEdges(n, start, extent,
+				[this](int k) { return m_splitRatios[m_visibleChildren[k]]; },
+				[this](int k) -> const LayoutConstraints& { return m_children[m_visibleChildren[k]]->m_constraints; },
+				m_edges.data(), m_solverScratch.data());
+		}
+		else SplitMath::OffsetEdges(n, start, extent, m_visibleOffsets.data(), m_edges.data());
 
-		float sum = 0.f;
-		for (int i : visIdx) sum += m_splitRatios[i];
-		if (sum <= 1e-6f) {
-			float eq = 1.f / visIdx.size();
-			for (int i : visIdx) m_splitRatios[i] = eq;
-			sum = 1.f;
+		for (int k = 0; k < n; ++k) {
+			const float a = m_edges[k];
+			const float b = m_edges[k + 1];
+			CustomLayoutNode* child = m_children[m_visibleChildren[k]];
+			if (m_isVertical) child->ResizeNodeAndChildren(ImVec2(m_domainPos.x, a), ImVec2(m_domainSize.x, b - a));
+			else child->ResizeNodeAndChildren(ImVec2(a, m_domainPos.y), ImVec2(b - a, m_domainSize.y));
 		}
+		m_geometryDirty = false;
+	}
 
-		if (m_isVertical) {
-			float accY = m_domainPos.y;
-			const float totalH = m_domainSize.y;
-			for (size_t k = 0; k < visIdx.size(); ++k) {
-				int i = visIdx[k];
-				float h = totalH * (m_splitRatios[i] / sum);
-				m_children[i]->ResizeNodeAndChildren(ImVec2(m_domainPos.x, accY), ImVec2(m_domainSize.x, h));
-				accY += h;
-			}
+	// An edit of the children leaves the ancestors' visibility dirty; their
+	// visible children are the same, so refreshing them is one pass each.
+	void CustomLayoutNode::RelayoutSubtree() {
+		m_geometryDirty = true;
+		ResizeNodeAndChildren(m_domainPos, m_domainSize);
+		for (CustomLayoutNode* n = m_parent; n; n = n->m_parent) {
+			n->RefreshVisibility();
+			n->m_geometryDirty = false;
 		}
-		else {
-			float accX = m_domainPos.x;
-			const float totalW = m_domainSize.x;
-			for (size_t k = 0; k < visIdx.size(); ++k) {
-				int i = visIdx[k];
-				float w = totalW * (m_splitRatios[i] / sum);
-				m_children[i]->ResizeNodeAndChildren(ImVec2(accX, m_domainPos.y), ImVec2(w, m_domainSize.y));
-				accX += w;
+	}
+
+	CustomLayoutNode* CustomLayoutNode::FindEditRelayoutRoot() {
+		CustomLayoutNode* n = this;
+		while (n->m_parent && n->m_effectiveVisible != n->ComputeEffectiveVisibility()) n = n->m_parent;
+		return n;
+	}
+
+	bool CustomLayoutNode::IsLaidOut() const {
+		for (const CustomLayoutNode* n = this; ; n = n->m_parent) {
+			if (n->m_visibilityDirty || !n->m_effectiveVisible) return false;
+			const CustomLayoutNode* p = n->m_parent;
+			if (!p) return true;
+			bool found = false;
+			for (int i : p->LaidOutChildren()) if (p->m_children[i] == n) { found = true; break; }
+			if (!found) return false;
+		}
+	}
+
+	void CustomLayoutNode::RenderPanes(bool profileCosts) {
+		ImRect clip;
+		RenderPanesClipped(profileCosts, AncestorScrollClip(clip) ? &clip : nullptr);
+	}
+
+	void CustomLayoutNode::RenderPanesClipped(bool profileCosts, const ImRect* clip) {
+		if (!m_effectiveVisible || m_visibilityDirty) return;
+		if (IsWindowNode()) {
+			m_paneCache.Submit(m_paneFunc, m_domainPos, m_domainSize, profileCosts ? &m_costs : nullptr, clip);
+			m_lastSubmitTime = GImGui->Time;
+			m_paneCompacted = false;
+			return;
+		}
+		ImRect view;
+		if (m_kind == LayoutNode_Scroll) {
+			view = ScrollViewRect();
+			if (clip) view.ClipWithFull(*clip);
+			clip = &view;
+		}
+		for (int i : LaidOutChildren()) m_children[i]->RenderPanesClipped(profileCosts, clip);
+	}
+
+	ImRect CustomLayoutNode::ScrollViewRect() const {
+		return ImRect(m_domainPos, ImVec2(m_domainPos.x + m_domainSize.x - m_scrollBarWidth, m_domainPos.y + m_domainSize.y));
+	}
+
+	bool CustomLayoutNode::AncestorScrollClip(ImRect& out) const {
+		bool clipped = false;
+		for (const CustomLayoutNode* n = m_parent; n; n = n->m_parent) {
+			if (n->m_kind != LayoutNode_Scroll) continue;
+			if (clipped) out.ClipWithFull(n->ScrollViewRect());
+			else out = n->ScrollViewRect();
+			clipped = true;
+		}
+		return clipped;
+	}
+
+	void CustomLayoutNode::CollectPrepareJobs(std::vector<PanePrepareJob>& out, int base) {
+		m_prepareJobBegin = base + (int)out.size();
+		if (m_effectiveVisible && !m_visibilityDirty) {
+			if (IsWindowNode()) {
+				if (m_paneFunc.HasPrepare())
+					out.push_back({ &m_paneFunc, ImRect(m_domainPos, ImVec2(m_domainPos.x + m_domainSize.x, m_domainPos.y + m_domainSize.y)) });
+			}
+			else {
+				for (int i : LaidOutChildren()) m_children[i]->CollectPrepareJobs(out, base);
 			}
 		}
+		m_prepareJobEnd = base + (int)out.size();
 	}
 
+	int CustomLayoutNode::GetPrepareJobBegin() const { return m_prepareJobBegin; }
+	int CustomLayoutNode::GetPrepareJobEnd() const { return m_prepareJobEnd; }
+
 	void CustomLayoutNode::RenderNodeAndChildren() {
-		if (!IsEffectivelyVisible()) return;
+		ImRect clip;
+		const bool clipped = AncestorScrollClip(clip);
+		ImDrawList* dl = ImGui::GetForegroundDrawList();
+		if (clipped) dl->PushClipRect(clip.Min, clip.Max, true);
+		RenderNodeClipped(clipped ? &clip : nullptr);
+		if (clipped) dl->PopClipRect();
+	}
+
+	// Splitter lines go to the foreground draw list, so below a scroll view
+	// they are clipped by its clip rect; tab and scroll bars are windows.
+	void CustomLayoutNode::RenderNodeClipped(const ImRect* clip) {
+		if (!m_effectiveVisible || m_visibilityDirty) return;
 		if (IsWindowNode()) return;
+		if (m_kind == LayoutNode_Tabs) DrawTabBar(clip);
+		if (m_kind == LayoutNode_Scroll) DrawScrollBar(clip);
 
-		std::vector<int> visIdx;
-		for (int i = 0; i < (int)m_children.size(); ++i)
-			if (m_children[i] && m_children[i]->IsEffectivelyVisible()) visIdx.push_back(i);
-		if (visIdx.size() >= 2) {
-			float sum = 0.f; for (int i : visIdx) sum += m_splitRatios[i]; if (sum <= 1e-6f) sum = 1.f;
-			if (m_isVertical) {
-				float acc = m_domainPos.y;
-				for (size_t k = 0; k < visIdx.size() - 1; ++k) {
-					int i = visIdx[k];
-					acc += m_domainSize.y * (m_splitRatios[i] / sum);
-					ImGui::GetForegroundDrawList()->AddLine(
-						ImVec2(m_domainPos.x, acc),
-						ImVec2(m_domainPos.x + m_domainSize.x, acc),
-						IM_COL32(100, 100, 100, 255), m_splitterWidth);
-				}
-			}
-			else {
-				float acc = m_domainPos.x;
-				for (size_t k = 0; k < visIdx.size() - 1; ++k) {
-					int i = visIdx[k];
-					acc += m_domainSize.x * (m_splitRatios[i] / sum);
-					ImGui::GetForegroundDrawList()->AddLine(
-						ImVec2(acc, m_domainPos.y),
-						ImVec2(acc, m_domainPos.y + m_domainSize.y),
-						IM_COL32(100, 100, 100, 255), m_splitterWidth);
-				}
+		ImDrawList* dl = ImGui::GetForegroundDrawList();
+		if (m_grid) {
+			for (const GridState::Segment& seg : m_grid->segments) {
+				if (seg.rowBoundary)
+					dl->AddLine(ImVec2(seg.spanMin, seg.pos), ImVec2(seg.spanMax, seg.pos), IM_COL32(100, 100, 100, 255), m_splitterWidth);
+				else
+					dl->AddLine(ImVec2(seg.pos, seg.spanMin), ImVec2(seg.pos, seg.spanMax), IM_COL32(100, 100, 100, 255), m_splitterWidth);
 			}
 		}
+		for (int k = 0; k < (int)m_edges.size() - 2; ++k) {
+			const float b = BoundaryPos(k);
+			if (m_isVertical)
+				dl->AddLine(ImVec2(m_domainPos.x, b), ImVec2(m_domainPos.x + m_domainSize.x, b),
+					IM_COL32(100, 100, 100, 255), m_splitterWidth);
+			else
+				dl->AddLine(ImVec2(b, m_domainPos.y), ImVec2(b, m_domainPos.y + m_domainSize.y),
+					IM_COL32(100, 100, 100, 255), m_splitterWidth);
+		}
 
-		for (auto* c : m_children) if (c) c->RenderNodeAndChildren();
+		if (m_kind != LayoutNode_Scroll) {
+			for (int i : LaidOutChildren()) m_children[i]->RenderNodeClipped(clip);
+			return;
+		}
+		ImRect view = ScrollViewRect();
+		if (clip) view.ClipWithFull(*clip);
+		dl->PushClipRect(view.Min, view.Max, true);
+		for (int i : LaidOutChildren()) m_children[i]->RenderNodeClipped(&view);
+		dl->PopClipRect();
 	}
 
 	bool CustomLayoutNode::FindHoveredSplitter(const ImVec2& mousePos, CustomLayoutNode*& outNode, int& outBoundaryIndex) {
 		outNode = nullptr; outBoundaryIndex = -1;
-		if (!IsEffectivelyVisible() || IsWindowNode()) {
-			// Do nothing
-		}
-		else {
-			const float pad = 8.f;
-			std::vector<int> visIdx;
-			for (int i = 0; i < (int)m_children.size(); ++i)
-				if (m_children[i] && m_children[i]->IsEffectivelyVisible()) visIdx.push_back(i);
-			if (visIdx.size() >= 2) {
-				float sum = 0.f; for (int i : visIdx) sum += m_splitRatios[i]; if (sum <= 1e-6f) sum = 1.f;
-				if (m_isVertical) {
-					float acc = m_domainPos.y;
-					for (size_t k = 0; k < visIdx.size() - 1; ++k) {
-						int i = visIdx[k]; acc += m_domainSize.y * (m_splitRatios[i] / sum);
-						if (mousePos.y >= acc - pad && mousePos.y <= acc + pad &&
-							mousePos.x >= m_domainPos.x && mousePos.x <= m_domainPos.x + m_domainSize.x) {
-							outNode = this; outBoundaryIndex = (int)k; return true;
-						}
-					}
-				}
-				else {
-					float acc = m_domainPos.x;
-					for (size_t k = 0; k < visIdx.size() - 1; ++k) {
-						int i = visIdx[k]; acc += m_domainSize.x * (m_splitRatios[i] / sum);
-						if (mousePos.x >= acc - pad && mousePos.x <= acc + pad &&
-							mousePos.y >= m_domainPos.y && mousePos.y <= m_domainPos.y + m_domainSize.y) {
-							outNode = this; outBoundaryIndex = (int)k; return true;
-						}
-					}
+		if (!m_effectiveVisible || m_visibilityDirty || IsWindowNode()) return false;
+
+		const float pad = 8.f;
+		if (m_grid) {
+			for (const GridState::Segment& seg : m_grid->segments) {
+				const float along = seg.rowBoundary ? mousePos.y : mousePos.x;
+				const float across = seg.rowBoundary ? mousePos.x : mousePos.y;
+				if (ImFabs(along - seg.pos) <= pad && across >= seg.spanMin && across <= seg.spanMax) {
+					outNode = this; outBoundaryIndex = seg.boundaryIndex; return true;
 				}
 			}
+			CustomLayoutNode* child = GridChildAt(mousePos);
+			return child && child->FindHoveredSplitter(mousePos, outNode, outBoundaryIndex);
+		}
+		if (m_kind == LayoutNode_Scroll) {
+			if (!ScrollViewRect().Contains(mousePos)) return false;
+			for (int i : LaidOutChildren())
+				if (m_children[i]->FindHoveredSplitter(mousePos, outNode, outBoundaryIndex)) return true;
+			return false;
 		}
 
-		for (auto* c : m_children) if (c) {
-			if (c->FindHoveredSplitter(mousePos, outNode, outBoundaryIndex)) return true;
+		const int n = (int)m_visibleChildren.size();
+		if (n == 0 || (int)m_edges.size() != n + 1) return false;
+
+		const float along = m_isVertical ? mousePos.y : mousePos.x;
+		const float across = m_isVertical ? mousePos.x : mousePos.y;
+		const float acrossMin = m_isVertical ? m_domainPos.x : m_domainPos.y;
+		const float acrossMax = acrossMin + (m_isVertical ? m_domainSize.x : m_domainSize.y);
+		if (across < acrossMin || across > acrossMax) return false;
+
+		// interior boundaries are edges [1, n), sorted by construction
+		const float* first = m_edges.data() + 1;
+		const float* last = m_edges.data() + n;
+		const float* it = std::lower_bound(first, last, along - pad);
+		if (it != last && *it <= along + pad) {
+			outNode = this; outBoundaryIndex = (int)(it - first); return true;
 		}
-		return false;
+
+		// only the child under the mouse can own a hovered splitter
+		const int k = (int)(std::upper_bound(first, last, along) - first);
+		return m_children[m_visibleChildren[k]]->FindHoveredSplitter(mousePos, outNode, outBoundaryIndex);
+	}
+
+	CustomLayoutNode* CustomLayoutNode::FindPaneAt(const ImVec2& pos) {
+		if (pos.x < m_domainPos.x || pos.y < m_domainPos.y ||
+			pos.x >= m_domainPos.x + m_domainSize.x || pos.y >= m_domainPos.y + m_domainSize.y) return nullptr;
+		CustomLayoutNode* node = this;
+		while (node->m_effectiveVisible && !node->m_visibilityDirty) {
+			if (node->IsWindowNode()) return node;
+			if (node->m_grid) {
+				if (!(node = node->GridChildAt(pos))) return nullptr;
+				continue;
+			}
+			if (node->m_kind == LayoutNode_Scroll) {
+				// children do not overlap, so at most one holds pos
+				CustomLayoutNode* hit = nullptr;
+				for (int i : node->LaidOutChildren()) {
+					CustomLayoutNode* c = node->m_children[i];
+					if (pos.x < c->m_domainPos.x + c->m_domainSize.x && pos.y >= c->m_domainPos.y && pos.y < c->m_domainPos.y + c->m_domainSize.y) { hit = c; break; }
+				}
+				if (!(node = hit)) return nullptr;
+				continue;
+			}
+			const int n = (int)node->m_visibleChildren.size();
+			if (n == 0 || (int)node->m_edges.size() != n + 1) return nullptr;
+			const float along = node->m_isVertical ? pos.y : pos.x;
+			if (along < node->m_edges[0] || along >= node->m_edges[n]) return nullptr;
+			const int k = (int)(std::upper_bound(node->m_edges.data() + 1, node->m_edges.data() + n, along) - (node->m_edges.data() + 1));
+			node = node->m_children[node->m_visibleChildren[k]];
+		}
+		return nullptr;
 	}
 
+	// O(1): moves the boundary by the mouse delta in pixels, limited by the two
+	// neighbours' constraints, and stores the result as their weights. Only the
+	// pair's ratios and the single offset between them change.
 	bool CustomLayoutNode::HandleSplitterDragAt(int boundaryIndex, const ImVec2& mouseDelta) {
 		if (boundaryIndex < 0) return false;
-		if (!IsEffectivelyVisible() || IsWindowNode()) return false;
+		if (m_grid) return HandleGridDragAt(boundaryIndex, mouseDelta);
+		RefreshVisibility();
+		if (!m_effectiveVisible || IsWindowNode()) return false;
 
-		std::vector<int> visIdx;
-		for (int i = 0; i < (int)m_children.size(); ++i)
-			if (m_children[i] && m_children[i]->IsEffectivelyVisible()) visIdx.push_back(i);
+		const std::vector<int>& visIdx = m_visibleChildren;
 		if (visIdx.size() < 2) return false;
 		if (boundaryIndex >= (int)visIdx.size() - 1) return false;
+		if (m_edges.size() != visIdx.size() + 1) return false;
+
+		const float delta = m_isVertical ? mouseDelta.y : mouseDelta.x;
+		if (delta == 0.f) return false;
+
+		const int iA = visIdx[boundaryIndex];
+		const int iB = visIdx[boundaryIndex + 1];
+		const float* e = m_edges.data() + boundaryIndex;
+		RefreshOffsets();
+		if (!SplitMath::DragBoundary(e[1] - e[0], e[2] - e[0], m_children[iA]->m_constraints, m_children[iB]->m_constraints,
+			delta, m_splitRatios[iA], m_splitRatios[iB])) return false;
+		m_visibleOffsets[boundaryIndex + 1] = m_visibleOffsets[boundaryIndex] + m_splitRatios[iA] / m_visibleRatioSum;
+		MarkGeometryDirty();
+
+		return true;
+	}
+
+	void CustomLayoutNode::CollectSplitters(SplitterIndex& index) const {
+		ImRect clip;
+		CollectSplittersClipped(index, AncestorScrollClip(clip) ? &clip : nullptr);
+	}
+
+	// Below a scroll view only the part of a boundary inside the view can be
+	// hovered, so segments are cut to it and dropped if they lie outside.
+	void CustomLayoutNode::CollectSplittersClipped(SplitterIndex& index, const ImRect* clip) const {
+		if (!m_effectiveVisible || m_visibilityDirty || IsWindowNode()) return;
+		CustomLayoutNode* self = const_cast<CustomLayoutNode*>(this);
+		auto add = [&](bool horizontalLine, float pos, float spanMin, float spanMax, int boundaryIndex) {
+			if (clip) {
+				const ImVec2 along = horizontalLine ? ImVec2(clip->Min.y, clip->Max.y) : ImVec2(clip->Min.x, clip->Max.x);
+				if (pos < along.x || pos > along.y) return;
+				spanMin = ImMax(spanMin, horizontalLine ? clip->Min.x : clip->Min.y);
+				spanMax = ImMin(spanMax, horizontalLine ? clip->Max.x : clip->Max.y);
+				if (spanMin >= spanMax) return;
+			}
+			index.Add(horizontalLine, pos, spanMin, spanMax, boundaryIndex, self);
+		};
+		if (m_grid)
+			for (const GridState::Segment& seg : m_grid->segments) add(seg.rowBoundary, seg.pos, seg.spanMin, seg.spanMax, seg.boundaryIndex);
+		for (int k = 0; k < (int)m_edges.size() - 2; ++k) {
+			if (m_isVertical) add(true, BoundaryPos(k), m_domainPos.x, m_domainPos.x + m_domainSize.x, k);
+			else add(false, BoundaryPos(k), m_domainPos.y, m_domainPos.y + m_domainSize.y, k);
+		}
+
+		ImRect view;
+		if (m_kind == LayoutNode_Scroll) {
+			view = ScrollViewRect();
+			if (clip) view.ClipWithFull(*clip);
+			clip = &view;
+		}
+		for (int i : LaidOutChildren()) m_children[i]->CollectSplittersClipped(index, clip);
+	}
+
+	int CustomLayoutNode::VisibleChildCount() const {
+		if (!m_visibilityDirty) return (int)m_visibleChildren.size();
+		int c = 0; for (auto* x : m_children) if (x && x->IsEffectivelyVisible()) ++c; return c;
+	}
+
+	LayoutNodeKind CustomLayoutNode::GetKind() const { return m_kind; }
+	bool CustomLayoutNode::IsTabContainer() const { return m_kind == LayoutNode_Tabs; }
+	bool CustomLayoutNode::IsGrid() const { return m_kind == LayoutNode_Grid; }
+	bool CustomLayoutNode::IsScrollContainer() const { return m_kind == LayoutNode_Scroll; }
+	bool CustomLayoutNode::IsWindowNode() const { return (bool)m_paneFunc; }
+	bool CustomLayoutNode::IsVerticalSplitter() const { return !IsWindowNode() && m_kind == LayoutNode_Split && m_isVertical; }
+	bool CustomLayoutNode::IsHorizontalSplitter() const { return !IsWindowNode() && m_kind == LayoutNode_Split && !m_isVertical; }
+
+	// Grid boundaries are numbered columns first: [0, columns - 1) are column
+	// boundaries, the rest row boundaries.
+	bool CustomLayoutNode::IsVerticalBoundary(int boundaryIndex) const {
+		if (m_grid) return boundaryIndex >= (int)m_grid->columns.size() - 1;
+		return m_isVertical;
+	}
+
+	void CustomLayoutNode::AddTab(CustomLayoutNode* child) {
+		assert(IsTabContainer() && "AddTab only valid on tab containers");
+		if (!child) return;
+		AttachChild(child);
+		MarkVisibilityDirty();
+	}
+
+	void CustomLayoutNode::SetActiveTab(int childIndex) {
+		assert(IsTabContainer() && "SetActiveTab only valid on tab containers");
+		assert(childIndex >= 0 && childIndex < (int)m_children.size() && "Tab index out of range");
+		if (m_children[childIndex] == m_activeTab) return;
+		m_activeTab = m_children[childIndex];
+		m_tabSelectPending = true;
+		// MarkVisibilityDirty stops at dirty nodes; the tab container must be
+		// re-resolved even if it is already flagged
+		m_visibilityDirty = false;
+		MarkVisibilityDirty();
+	}
+
+	int CustomLayoutNode::GetActiveTab() const {
+		return IndexOfChild(ResolveActiveTab());
+	}
+
+	// Only the children's own flags are read; inactive subtrees are not visited.
+	CustomLayoutNode* CustomLayoutNode::ResolveActiveTab() const {
+		if (m_activeTab && m_activeTab->m_visible) return m_activeTab;
+		for (CustomLayoutNode* c : m_children) if (c && c->m_visible) return c;
+		return nullptr;
+	}
+
+	// Cuts what a window drew this frame, and the area it is hovered in from the
+	// next frame on, to clip. Child windows are cut too; popups are left alone.
+	static void ClipWindowToRect(ImGuiWindow* window, const ImRect& clip) {
+		for (ImDrawCmd& cmd : window->DrawList->CmdBuffer) {
+			cmd.ClipRect.x = ImMax(cmd.ClipRect.x, clip.Min.x);
+			cmd.ClipRect.y = ImMax(cmd.ClipRect.y, clip.Min.y);
+			cmd.ClipRect.z = ImMax(ImMin(cmd.ClipRect.z, clip.Max.x), cmd.ClipRect.x);
+			cmd.ClipRect.w = ImMax(ImMin(cmd.ClipRect.w, clip.Max.y), cmd.ClipRect.y);
+		}
+		window->OuterRectClipped.ClipWithFull(clip);
+		for (ImGuiWindow* child : window->DC.ChildWindows) ClipWindowToRect(child, clip);
+	}
+
+	// A borderless window over the top strip of the node. A click only records
+	// the new tab; the switch is laid out on the next frame.
+	void CustomLayoutNode::DrawTabBar(const ImRect* clip) {
+		char name[48];
+		ImFormatString(name, IM_ARRAYSIZE(name), "##LayoutTabs%p", (void*)this);
+		ImGui::SetNextWindowPos(m_domainPos);
+		ImGui::SetNextWindowSize(ImVec2(m_domainSize.x, m_tabBarHeight));
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowMinSize, ImVec2(1, 1));
+		ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+		ImGui::Begin(name, nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings |
+			ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+		int clicked = -1;
+		bool pendingApplied = false;
+		if (ImGui::BeginTabBar("##tabs", ImGuiTabBarFlags_FittingPolicyResizeDown)) {
+			for (int i = 0; i < (int)m_children.size(); ++i) {
+				CustomLayoutNode* c = m_children[i];
+				if (!c || !c->m_visible) continue;
+				ImGui::PushID(i);
+				const bool isActive = c == m_activeTab;
+				if (ImGui::BeginTabItem(c->m_label.c_str(), nullptr, isActive && m_tabSelectPending ? ImGuiTabItemFlags_SetSelected : 0)) {
+					if (isActive) pendingApplied = true;
+					else if (!m_tabSelectPending) clicked = i;
+					ImGui::EndTabItem();
+				}
+				ImGui::PopID();
+			}
+			ImGui::EndTabBar();
+		}
+		if (clip) ClipWindowToRect(ImGui::GetCurrentWindow(), *clip);
+		ImGui::End();
+		ImGui::PopStyleVar(3);
+		if (pendingApplied) m_tabSelectPending = false;
+		if (clicked >= 0) SetActiveTab(clicked);
+	}
 
-		const float total = m_isVertical ? m_domainSize.y : m_domainSize.x;
-		if (total <= 1e-6f) return false;
-		const float deltaRatio = (m_isVertical ? mouseDelta.y : mouseDelta.x) / total;
-		if (deltaRatio == 0.f) return false;
+	void CustomLayoutNode::SetGridSize(int columns, int rows) {
+		assert(IsGrid() && "SetGridSize only valid on grid nodes");
+		assert(columns > 0 && rows > 0 && "Grid needs at least one column and one row");
+		m_grid->columns.resize(columns);
+		m_grid->rows.resize(rows);
+		m_grid->colEdges.reserve(columns + 1);
+		m_grid->rowEdges.reserve(rows + 1);
+		MarkVisibilityDirty();
+	}
+
+	void CustomLayoutNode::AddGridCell(CustomLayoutNode* child, int col, int row, int colSpan, int rowSpan) {
+		assert(IsGrid() && "AddGridCell only valid on grid nodes");
+		if (!child) return;
+		assert(col >= 0 && row >= 0 && colSpan > 0 && rowSpan > 0 &&
+			col + colSpan <= GetGridColumns() && row + rowSpan <= GetGridRows() && "Grid cell out of range");
+		const GridCell cell{ col, row, colSpan, rowSpan };
+		assert(std::none_of(m_children.begin(), m_children.end(), [&](const CustomLayoutNode* c) { return c->m_gridCell.Overlaps(cell); }) && "Grid cells must not overlap");
+		child->m_gridCell = cell;
+		AttachChild(child);
+		MarkVisibilityDirty();
+	}
+
+	void CustomLayoutNode::SetColumnTrack(int col, float weight, float minSize) {
+		assert(IsGrid() && col >= 0 && col < GetGridColumns() && "Column out of range");
+		m_grid->columns[col] = GridTrack{ ImMax(weight, 0.f), ImMax(minSize, 0.f) };
+		MarkGeometryDirty();
+	}
+
+	void CustomLayoutNode::SetRowTrack(int row, float weight, float minSize) {
+		assert(IsGrid() && row >= 0 && row < GetGridRows() && "Row out of range");
+		m_grid->rows[row] = GridTrack{ ImMax(weight, 0.f), ImMax(minSize, 0.f) };
+		MarkGeometryDirty();
+	}
+
+	int CustomLayoutNode::GetGridColumns() const { return m_grid ? (int)m_grid->columns.size() : 0; }
+	int CustomLayoutNode::GetGridRows() const { return m_grid ? (int)m_grid->rows.size() : 0; }
+	const GridTrack& CustomLayoutNode::GetColumnTrack(int col) const { return m_grid->columns[col]; }
+	const GridTrack& CustomLayoutNode::GetRowTrack(int row) const { return m_grid->rows[row]; }
+	const GridCell& CustomLayoutNode::GetGridCell() const { return m_gridCell; }
+
+	// Cells left outside by a later SetGridSize are clipped to the grid.
+	static GridCell ClipGridCell(const GridCell& c, int columns, int rows) {
+		GridCell r;
+		r.Col = ImClamp(c.Col, 0, columns - 1);
+		r.Row = ImClamp(c.Row, 0, rows - 1);
+		r.ColSpan = ImClamp(c.ColSpan, 1, columns - r.Col);
+		r.RowSpan = ImClamp(c.RowSpan, 1, rows - r.Row);
+		return r;
+	}
 
-		int iA = visIdx[boundaryIndex];
-		int iB = visIdx[boundaryIndex + 1];
+	// Same suffix-sum walk as SplitMath::SolveEdges with minimums only: one backward
+	// and one forward pass over the tracks.
+	static void SolveGridTracks(const std::vector<GridTrack>& tracks, float start, float extent, std::vector<float>& edges, std::vector<float>& scratch) {
+		const int n = (int)tracks.size();
+		scratch.resize(2 * (n + 1));
+		float* sufMin = scratch.data();
+		float* sufWeight = sufMin + (n + 1);
+		sufMin[n] = sufWeight[n] = 0.f;
+		for (int k = n - 1; k >= 0; --k) {
+			sufMin[k] = sufMin[k + 1] + tracks[k].MinSize;
+			sufWeight[k] = sufWeight[k + 1] + tracks[k].Weight;
+		}
+
+		edges.resize(n + 1);
+		float pos = start, rem = extent;
+		edges[0] = start;
+		for (int k = 0; k < n; ++k) {
+			float size = sufWeight[k] > 0.f ? rem * (tracks[k].Weight / sufWeight[k]) : rem / (n - k);
+			size = ImMax(size, tracks[k].MinSize);
+			size = ImMin(size, rem - sufMin[k + 1]);
+			size = ImClamp(size, 0.f, ImMax(rem, 0.f));
+			pos += size;
+			rem -= size;
+			edges[k + 1] = pos;
+		}
+		edges[n] = start + extent;
+	}
 
-		float sumVis = 0.f; for (int i : visIdx) sumVis += m_splitRatios[i]; if (sumVis <= 1e-6f) sumVis = 1.f;
+	void CustomLayoutNode::RefreshGridCells() {
+		GridState& g = *m_grid;
+		const int columns = (int)g.columns.size(), rows = (int)g.rows.size();
+		g.cellOwner.assign(columns * rows, -1);
+		for (int i : m_visibleChildren) {
+			const GridCell c = ClipGridCell(m_children[i]->m_gridCell, columns, rows);
+			for (int r = c.Row; r < c.Row + c.RowSpan; ++r)
+				for (int col = c.Col; col < c.Col + c.ColSpan; ++col) g.cellOwner[r * columns + col] = i;
+		}
+	}
 
-		float rA = m_splitRatios[iA] / sumVis;
-		float rB = m_splitRatios[iB] / sumVis;
+	// Sizes both track sets, hands every visible cell the rect between its
+	// track edges and records the boundary pieces that separate two different
+	// cells, merged along the boundary.
+	void CustomLayoutNode::ResizeGrid() {
+		GridState& g = *m_grid;
+		const int columns = (int)g.columns.size(), rows = (int)g.rows.size();
+		SolveGridTracks(g.columns, m_domainPos.x, m_domainSize.x, g.colEdges, g.scratch);
+		SolveGridTracks(g.rows, m_domainPos.y, m_domainSize.y, g.rowEdges, g.scratch);
+		m_edges.clear();
 
-		float newA = Clamp01(rA + deltaRatio);
-		float newB = Clamp01(rB - deltaRatio);
-		const float minr = m_minRatio;
-		newA = newA < minr ? minr : newA;
-		newB = newB < minr ? minr : newB;
+		for (int i : m_visibleChildren) {
+			const GridCell c = ClipGridCell(m_children[i]->m_gridCell, columns, rows);
+			const ImVec2 pos(g.colEdges[c.Col], g.rowEdges[c.Row]);
+			m_children[i]->ResizeNodeAndChildren(pos, ImVec2(g.colEdges[c.Col + c.ColSpan] - pos.x, g.rowEdges[c.Row + c.RowSpan] - pos.y));
+		}
 
-		float pairSum = rA + rB;
-		if (newA + newB > pairSum) {
-			float excess = (newA + newB) - pairSum;
-			if (deltaRatio > 0) newA -= excess; else newB -= excess;
-			newA = (std::max)(minr, newA);
-			newB = (std::max)(minr, newB);
+		g.segments.clear();
+		auto owner = [&](int col, int row) { return g.cellOwner[row * columns + col]; };
+		for (int k = 0; k + 1 < columns; ++k) {
+			int runStart = -1;
+			for (int r = 0; r <= rows; ++r) {
+				const bool split = r < rows && owner(k, r) != owner(k + 1, r);
+				if (split && runStart < 0) runStart = r;
+				if (!split && runStart >= 0) {
+					g.segments.push_back({ g.colEdges[k + 1], g.rowEdges[runStart], g.rowEdges[r], k, false });
+					runStart = -1;
+				}
+			}
+		}
+		for (int k = 0; k + 1 < rows; ++k) {
+			int runStart = -1;
+			for (int col = 0; col <= columns; ++col) {
+				const bool split = col < columns && owner(col, k) != owner(col, k + 1);
+				if (split && runStart < 0) runStart = col;
+				if (!split && runStart >= 0) {
+					g.segments.push_back({ g.rowEdges[k + 1], g.colEdges[runStart], g.colEdges[col], columns - 1 + k, true });
+					runStart = -1;
+				}
+			}
 		}
+	}
+
+	// O(1) like a splitter drag: only the weights of the two tracks next to the
+	// boundary change.
+	bool CustomLayoutNode::HandleGridDragAt(int boundaryIndex, const ImVec2& mouseDelta) {
+		RefreshVisibility();
+		if (!m_effectiveVisible) return false;
+		GridState& g = *m_grid;
+		const int columns = (int)g.columns.size();
+		const bool rowBoundary = boundaryIndex >= columns - 1;
+		const int k = rowBoundary ? boundaryIndex - (columns - 1) : boundaryIndex;
+		std::vector<GridTrack>& tracks = rowBoundary ? g.rows : g.columns;
+		const std::vector<float>& e = rowBoundary ? g.rowEdges : g.colEdges;
+		if (k + 1 >= (int)tracks.size() || e.size() != tracks.size() + 1) return false;
 
-		float othersSum = sumVis - (m_splitRatios[iA] + m_splitRatios[iB]);
-		float newPairNormSum = newA + newB;
-		float scale = (sumVis - othersSum) / (newPairNormSum > 1e-6f ? newPairNormSum : 1.f);
-		m_splitRatios[iA] = newA * scale;
-		m_splitRatios[iB] = newB * scale;
+		const float delta = rowBoundary ? mouseDelta.y : mouseDelta.x;
+		if (delta == 0.f) return false;
 
+		GridTrack& a = tracks[k];
+		GridTrack& b = tracks[k + 1];
+		const float sizeA = e[k + 1] - e[k];
+		const float pair = e[k + 2] - e[k];
+		if (pair <= 1e-6f) return false;
+		const float lo = a.MinSize, hi = pair - b.MinSize;
+		if (lo > hi) return false;
+		const float newA = ImClamp(sizeA + delta, lo, hi);
+		if (newA == sizeA) return false;
+
+		const float pairWeight = a.Weight + b.Weight;
+		a.Weight = pairWeight * (newA / pair);
+		b.Weight = pairWeight - a.Weight;
+		MarkGeometryDirty();
 		return true;
 	}
 
-	int CustomLayoutNode::VisibleChildCount() const {
-		int c = 0; for (auto* x : m_children) if (x && x->IsEffectivelyVisible()) ++c; return c;
+	CustomLayoutNode* CustomLayoutNode::GridChildAt(const ImVec2& pos) const {
+		const GridState& g = *m_grid;
+		const int columns = (int)g.columns.size(), rows = (int)g.rows.size();
+		if ((int)g.colEdges.size() != columns + 1 || (int)g.rowEdges.size() != rows + 1 || (int)g.cellOwner.size() != columns * rows) return nullptr;
+		if (pos.x < g.colEdges[0] || pos.x >= g.colEdges[columns] || pos.y < g.rowEdges[0] || pos.y >= g.rowEdges[rows]) return nullptr;
+		const int col = (int)(std::upper_bound(g.colEdges.data() + 1, g.colEdges.data() + columns, pos.x) - (g.colEdges.data() + 1));
+		const int row = (int)(std::upper_bound(g.rowEdges.data() + 1, g.rowEdges.data() + rows, pos.y) - (g.rowEdges.data() + 1));
+		const int owner = g.cellOwner[row * columns + col];
+		return owner >= 0 ? m_children[owner] : nullptr;
 	}
 
-	bool CustomLayoutNode::IsWindowNode() const { return m_pfnCustomWindowFunc != nullptr; }
-	bool CustomLayoutNode::IsVerticalSplitter() const { return !IsWindowNode() && m_isVertical; }
-	bool CustomLayoutNode::IsHorizontalSplitter() const { return !IsWindowNode() && !m_isVertical; }
+	void CustomLayoutNode::AddScrollChild(CustomLayoutNode* child) {
+		assert(IsScrollContainer() && "AddScrollChild only valid on scroll containers");
+		if (!child) return;
+		AttachChild(child);
+		MarkVisibilityDirty();
+	}
+
+	void CustomLayoutNode::SetScrollItemExtent(float extent) {
+		assert(IsScrollContainer() && "SetScrollItemExtent only valid on scroll containers");
+		m_scrollItemExtent = ImMax(extent, 1.f);
+		m_ratiosDirty = true;
+		MarkGeometryDirty();
+	}
+
+	// Clamped to the content at the next layout pass.
+	void CustomLayoutNode::SetScrollPos(float pos) {
+		assert(IsScrollContainer() && "SetScrollPos only valid on scroll containers");
+		pos = ImMax(pos, 0.f);
+		if (pos == m_scrollPos) return;
+		m_scrollPos = pos;
+		MarkGeometryDirty();
+	}
+
+	float CustomLayoutNode::GetScrollPos() const { return m_scrollPos; }
+
+	float CustomLayoutNode::GetScrollContentExtent() const {
+		return m_kind == LayoutNode_Scroll && !m_visibleOffsets.empty() ? m_visibleOffsets.back() : 0.f;
+	}
+
+	ChildIndexSpan CustomLayoutNode::GetOnScreenChildren() const {
+		if (m_visibilityDirty) return ChildIndexSpan{ nullptr, nullptr };
+		return LaidOutChildren();
+	}
+
+	// All visible children, except for a scroll container: only the slice found
+	// by its last layout pass.
+	ChildIndexSpan CustomLayoutNode::LaidOutChildren() const {
+		const int* first = m_visibleChildren.data();
+		const int n = (int)m_visibleChildren.size();
+		if (m_kind != LayoutNode_Scroll) return ChildIndexSpan{ first, first + n };
+		const int begin = ImMin(m_scrollFirst, n);
+		return ChildIndexSpan{ first + begin, first + ImClamp(m_scrollLast, begin, n) };
+	}
+
+	// Pixel offsets of the visible children along the content; only rebuilt
+	// after visibility, constraint or item extent changes.
+	void CustomLayoutNode::RefreshScrollOffsets() {
+		if (!m_ratiosDirty) return;
+		const size_t n = m_visibleChildren.size();
+		m_visibleOffsets.resize(n + 1);
+		float acc = 0.f;
+		m_visibleOffsets[0] = 0.f;
+		for (size_t k = 0; k < n; ++k) {
+			const LayoutConstraints& c = m_children[m_visibleChildren[k]]->m_constraints;
+			acc += c.IsFixed() ? c.FixedSize : ImClamp(m_scrollItemExtent, c.MinSize, c.MaxSize);
+			m_visibleOffsets[k + 1] = acc;
+		}
+		m_ratiosDirty = false;
+	}
+
+	// Two binary searches find the on-screen slice; only that slice is resized,
+	// so a scroll step costs O(log n + on-screen children). Children cut by the
+	// edge of the view keep their full extent; rendering and hit-tests clip them.
+	void CustomLayoutNode::ResizeScroll() {
+		RefreshScrollOffsets();
+		const int n = (int)m_visibleChildren.size();
+		const float* offsets = m_visibleOffsets.data();
+		const float view = m_domainSize.y;
+		const float content = offsets[n];
+		m_scrollBarWidth = content > view ? ImMin(ImGui::GetStyle().ScrollbarSize, m_domainSize.x) : 0.f;
+		m_scrollPos = ImClamp(m_scrollPos, 0.f, ImMax(content - view, 0.f));
+		m_scrollFirst = (int)(std::upper_bound(offsets + 1, offsets + n + 1, m_scrollPos) - (offsets + 1));
+		m_scrollLast = (int)(std::lower_bound(offsets + m_scrollFirst, offsets + n, m_scrollPos + view) - offsets);
+		m_edges.clear();
+
+		const float top = m_domainPos.y - m_scrollPos;
+		const float width = m_domainSize.x - m_scrollBarWidth;
+		for (int k = m_scrollFirst; k < m_scrollLast; ++k)
+			m_children[m_visibleChildren[k]]->ResizeNodeAndChildren(ImVec2(m_domainPos.x, top + offsets[k]), ImVec2(width, offsets[k + 1] - offsets[k]));
+	}
+
+	// A strip window along the right edge while the content overflows. The
+	// wheel scrolls the container when the window under the mouse lies inside
+	// it and cannot scroll itself. The new position is laid out next frame.
+	void CustomLayoutNode::DrawScrollBar(const ImRect* clip) {
+		ImGuiContext& g = *GImGui;
+		const ImRect rect(m_domainPos, ImVec2(m_domainPos.x + m_domainSize.x, m_domainPos.y + m_domainSize.y));
+		float scroll = m_scrollPos;
+		// panes cut by the view are only hovered inside it
+		ImGuiWindow* hovered = g.HoveredWindow;
+		if (g.IO.MouseWheel != 0.f && hovered && hovered->ScrollMax.y <= 0.f && rect.Contains(hovered->OuterRectClipped))
+			scroll -= g.IO.MouseWheel * ImTrunc(ImMin(5.f * g.FontSize, m_domainSize.y * 0.67f));
+
+		if (m_scrollBarWidth > 0.f) {
+			char name[48];
+			ImFormatString(name, IM_ARRAYSIZE(name), "##LayoutScroll%p", (void*)this);
+			ImGui::SetNextWindowPos(ImVec2(rect.Max.x - m_scrollBarWidth, rect.Min.y));
+			ImGui::SetNextWindowSize(ImVec2(m_scrollBarWidth, m_domainSize.y));
+			ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+			ImGui::PushStyleVar(ImGuiStyleVar_WindowMinSize, ImVec2(1, 1));
+			ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+			ImGui::Begin(name, nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings |
+				ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+			ImGuiWindow* window = ImGui::GetCurrentWindow();
+			ImS64 pos = (ImS64)scroll;
+			if (ImGui::ScrollbarEx(window->Rect(), window->GetID("##bar"), ImGuiAxis_Y, &pos, (ImS64)m_domainSize.y, (ImS64)GetScrollContentExtent()))
+				scroll = (float)pos;
+			if (clip) ClipWindowToRect(window, *clip);
+			ImGui::End();
+			ImGui::PopStyleVar(3);
+		}
+		SetScrollPos(scroll);
+	}
 
 	const std::vector<CustomLayoutNode*>& CustomLayoutNode::GetChildren() const { return m_children; }
 	std::vector<CustomLayoutNode*>& CustomLayoutNode::GetChildren() { return m_children; }
 
+	const PaneCallable& CustomLayoutNode::GetWindowFunc() const { return m_paneFunc; }
+	PaneCallable& CustomLayoutNode::GetWindowFunc() { return m_paneFunc; }
+	float CustomLayoutNode::GetSplitRatio(int childIndex) const { return m_splitRatios[childIndex]; }
+
+	void CustomLayoutNode::SetSplitRatio(int childIndex, float weight) {
+		m_splitRatios[childIndex] = weight < 0.f ? 0.f : weight;
+		m_ratiosDirty = true;
+		MarkGeometryDirty();
+	}
+
+	void CustomLayoutNode::SetSizeConstraints(float minSize, float maxSize) {
+		m_constraints.MinSize = ImMax(minSize, 0.f);
+		m_constraints.MaxSize = ImMax(maxSize, m_constraints.MinSize);
+		MarkConstraintsDirty();
+	}
+
+	void CustomLayoutNode::SetFixedSize(float size) {
+		m_constraints.FixedSize = ImMax(size, 0.f);
+		MarkConstraintsDirty();
+	}
+
+	const LayoutConstraints& CustomLayoutNode::GetConstraints() const { return m_constraints; }
+
+	// Constraints are solved by the parent, which also decides whether it can
+	// keep using the unconstrained fast path.
+	void CustomLayoutNode::MarkConstraintsDirty() {
+		if (!m_parent) return;
+		m_parent->m_ratiosDirty = true;
+		m_parent->MarkGeometryDirty();
+	}
+
+	void CustomLayoutNode::SetRefreshPolicy(PaneRefreshPolicy policy, float rateHz) {
+		assert(IsWindowNode() && "Refresh policies only apply to window nodes");
+		m_paneCache.SetPolicy(policy, rateHz);
+	}
+	void CustomLayoutNode::InvalidatePane() { m_paneCache.Invalidate(); }
+
+	void CustomLayoutNode::ReleaseTransientBuffers() {
+		if (IsWindowNode()) {
+			m_paneCache.Release();
+			m_costs.Release();
+			return;
+		}
+		for (CustomLayoutNode* c : m_children) if (c) c->ReleaseTransientBuffers();
+	}
+
+	// Walks hidden subtrees too: those are exactly the panes that stop being
+	// submitted.
+	void CustomLayoutNode::CompactHiddenPanes(double cutoff, LayoutMemoryStats& stats) {
+		if (!IsWindowNode()) {
+			for (CustomLayoutNode* c : m_children) if (c) c->CompactHiddenPanes(cutoff, stats);
+			return;
+		}
+		++stats.Panes;
+		const size_t before = GetTransientMemoryBytes();
+		stats.BytesBefore += before;
+		if (!m_paneCompacted && m_lastSubmitTime < cutoff) {
+			m_paneCache.Release();
+			m_costs.Release();
+			stats.HookBytes += m_paneFunc.Compact();
+			m_paneCompacted = true;
+			stats.BytesAfter += GetTransientMemoryBytes();
+		}
+		else stats.BytesAfter += before;
+		if (m_paneCompacted) ++stats.CompactedPanes;
+	}
+
+	size_t CustomLayoutNode::GetTransientMemoryBytes() const {
+		if (IsWindowNode()) return m_paneCache.MemoryBytes() + m_costs.MemoryBytes();
+		size_t bytes = 0;
+		for (const CustomLayoutNode* c : m_children) if (c) bytes += c->GetTransientMemoryBytes();
+		return bytes;
+	}
+	const PaneRefreshCache& CustomLayoutNode::GetPaneCache() const { return m_paneCache; }
+	const PaneCostHistory& CustomLayoutNode::GetCostHistory() const { return m_costs; }
+
 	void CustomLayoutNode::EqualizeIfVisibleCountChanged() {
-		if (IsWindowNode()) return;
+		if (IsWindowNode() || m_kind != LayoutNode_Split) return;
 
-		std::vector<int> visIdx; visIdx.reserve(m_children.size());
-		for (int i = 0; i < (int)m_children.size(); ++i)
-			if (m_children[i] && m_children[i]->IsEffectivelyVisible()) visIdx.push_back(i);
-		size_t visCount = visIdx.size();
+		RefreshVisibility();
+		size_t visCount = m_visibleChildren.size();
 		if (!m_equalizeOnVisibleChange) { m_lastVisibleCount = visCount; return; }
 		if (visCount == m_lastVisibleCount) return;
 		m_lastVisibleCount = visCount;
 		if (visCount == 0) return;
 		float eq = 1.f / (float)visCount;
-		for (size_t k = 0; k < visIdx.size(); ++k) m_splitRatios[visIdx[k]] = eq;
-
-		for (int i = 0; i < (int)m_children.size(); ++i)
-			if (std::find(visIdx.begin(), visIdx.end(), i) == visIdx.end()) m_splitRatios[i] = 0.f;
+		std::fill(m_splitRatios.begin(), m_splitRatios.end(), 0.f);
+		for (int i : m_visibleChildren) m_splitRatios[i] = eq;
+		m_ratiosDirty = true;
+		MarkGeometryDirty();
 	}
 
 	ImVec2 CustomLayoutNode::GetDomainPos() const { return m_domainPos; }
 	ImVec2 CustomLayoutNode::GetDomainSize() const { return m_domainSize; }
 
-	float CustomLayoutNode::Clamp01(float v) { return v < 0.f ? 0.f : (v > 1.f ? 1.f : v); }
+
+	// PaneCostHistory implementation
+	void PaneCostHistory::Push(const PaneCostSample& sample) {
+		if (m_samples.Size < Capacity) {
+			if (m_samples.Capacity == 0) m_samples.reserve(Capacity);
+			m_samples.push_back(sample);
+		}
+		else m_samples[m_next] = sample;
+		m_next = (m_next + 1) % Capacity;
+	}
+
+	void PaneCostHistory::Clear() { m_samples.resize(0); m_next = 0; }
+	void PaneCostHistory::Release() { m_samples.clear(); m_next = 0; }
+	int PaneCostHistory::Size() const { return m_samples.Size; }
+	size_t PaneCostHistory::MemoryBytes() const { return (size_t)m_samples.Capacity * sizeof(PaneCostSample); }
+
+	const PaneCostSample& PaneCostHistory::Last() const {
+		assert(m_samples.Size > 0 && "No cost samples recorded");
+		return m_samples[(m_next + Capacity - 1) % Capacity];
+	}
+
+	PaneCostSummary PaneCostHistory::Summarize() const {
+		PaneCostSummary out;
+		out.Samples = m_samples.Size;
+		if (out.Samples == 0) return out;
+
+		float cpu[Capacity];
+		double cpuSum = 0.0, vtx = 0.0, idx = 0.0, cmds = 0.0;
+		for (int i = 0; i < m_samples.Size; ++i) {
+			const PaneCostSample& s = m_samples[i];
+			cpu[i] = s.CpuUs;
+			cpuSum += s.CpuUs; vtx += s.Vertices; idx += s.Indices; cmds += s.Commands;
+		}
+		const float inv = 1.f / out.Samples;
+		out.AvgCpuUs = (float)cpuSum * inv;
+		out.AvgVertices = (float)vtx * inv;
+		out.AvgIndices = (float)idx * inv;
+		out.AvgCommands = (float)cmds * inv;
+
+		// nearest-rank percentile over the window
+		const int rank = ImClamp((int)ceilf(0.99f * out.Samples) - 1, 0, out.Samples - 1);
+		std::nth_element(cpu, cpu + rank, cpu + out.Samples);
+		out.P99CpuUs = cpu[rank];
+		return out;
+	}
+
+	// PaneRefreshCache implementation
+	void PaneRefreshCache::SetPolicy(PaneRefreshPolicy policy, float rateHz) {
+		m_policy = policy;
+		m_rateHz = rateHz;
+		m_valid = false;
+		if (policy == PaneRefresh_EveryFrame) {
+			m_cmd.clear(); m_idx.clear(); m_vtx.clear();
+		}
+	}
+
+	PaneRefreshPolicy PaneRefreshCache::GetPolicy() const { return m_policy; }
+	void PaneRefreshCache::Invalidate() { m_valid = false; }
+
+	void PaneRefreshCache::Release() {
+		m_valid = false;
+		m_cmd.clear();
+		m_idx.clear();
+		m_vtx.clear();
+		ImGuiWindow* window = m_windowId ? ImGui::FindWindowByID(m_windowId) : nullptr;
+		if (window && !window->MemoryCompacted && window->LastFrameActive < GImGui->FrameCount)
+			ImGui::GcCompactTransientWindowBuffers(window);
+	}
+	bool PaneRefreshCache::WasReplayed() const { return m_replayed; }
+	ImGuiID PaneRefreshCache::GetWindowId() const { return m_windowId; }
+
+	size_t PaneRefreshCache::MemoryBytes() const {
+		size_t bytes = (size_t)m_cmd.Capacity * sizeof(ImDrawCmd) + (size_t)m_idx.Capacity * sizeof(ImDrawIdx) + (size_t)m_vtx.Capacity * sizeof(ImDrawVert);
+		if (ImGuiWindow* window = m_windowId ? ImGui::FindWindowByID(m_windowId) : nullptr) {
+			const ImDrawList* dl = window->DrawList;
+			bytes += (size_t)dl->CmdBuffer.Capacity * sizeof(ImDrawCmd) + (size_t)dl->IdxBuffer.Capacity * sizeof(ImDrawIdx) +
+				(size_t)dl->VtxBuffer.Capacity * sizeof(ImDrawVert) + (size_t)dl->_Path.Capacity * sizeof(ImVec2);
+		}
+		return bytes;
+	}
+
+	void PaneRefreshCache::Submit(const PaneCallable& func, const ImVec2& pos, const ImVec2& size, PaneCostHistory* costs, const ImRect* clip) {
+		if (!costs) SubmitUntimed(func, pos, size);
+		else SubmitTimed(func, pos, size, *costs);
+
+		// a replayed draw list was captured unclipped, so this runs every frame
+		if (clip && !clip->Contains(ImRect(pos, ImVec2(pos.x + size.x, pos.y + size.y))))
+			if (ImGuiWindow* window = m_windowId ? ImGui::FindWindowByID(m_windowId) : nullptr)
+				if (window->LastFrameActive == GImGui->FrameCount) ClipWindowToRect(window, *clip);
+	}
+
+	void PaneRefreshCache::SubmitTimed(const PaneCallable& func, const ImVec2& pos, const ImVec2& size, PaneCostHistory& costs) {
+		const int beginOrder = GImGui->WindowsActiveCount;
+		const auto start = std::chrono::steady_clock::now();
+		SubmitUntimed(func, pos, size);
+		const auto end = std::chrono::steady_clock::now();
+
+		PaneCostSample sample{ std::chrono::duration<float, std::micro>(end - start).count(), 0, 0, 0 };
+		if (ImGuiWindow* window = FindPaneWindow(beginOrder)) {
+			// remembered for the next lookup; replay is still gated by m_valid
+			m_windowId = window->ID;
+			sample.Vertices = window->DrawList->VtxBuffer.Size;
+			sample.Indices = window->DrawList->IdxBuffer.Size;
+			sample.Commands = window->DrawList->CmdBuffer.Size;
+		}
+		costs.Push(sample);
+	}
+
+	void PaneRefreshCache::SubmitUntimed(const PaneCallable& func, const ImVec2& pos, const ImVec2& size) {
+		ImGui::SetNextWindowPos(pos);
+		ImGui::SetNextWindowSize(size);
+		m_replayed = false;
+		if (m_policy == PaneRefresh_EveryFrame) {
+			// the window is looked up once so that Release() can compact it
+			if (m_windowId) { func(); return; }
+			const int beginOrder = GImGui->WindowsActiveCount;
+			func();
+			if (ImGuiWindow* window = FindPaneWindow(beginOrder)) m_windowId = window->ID;
+			return;
+		}
+
+		ImGuiWindow* window = m_valid ? ImGui::FindWindowByID(m_windowId) : nullptr;
+		if (window && !NeedsRefresh(window, pos, size)) {
+			Replay(window);
+			return;
+		}
+
+		const int beginOrder = GImGui->WindowsActiveCount;
+		func();
+		window = FindPaneWindow(beginOrder);
+		if (window && !window->Hidden) Capture(window, pos, size);
+		else m_valid = false;
+	}
+
+	// The pane's window is the first root window begun during the callback.
+	ImGuiWindow* PaneRefreshCache::FindPaneWindow(int beginOrder) const {
+		ImGuiContext& g = *GImGui;
+		auto begunByPane = [&](const ImGuiWindow* w) {
+			return w->LastFrameActive == g.FrameCount && w->BeginOrderWithinContext >= beginOrder &&
+				!(w->Flags & ImGuiWindowFlags_ChildWindow);
+		};
+		if (ImGuiWindow* cached = ImGui::FindWindowByID(m_windowId))
+			if (begunByPane(cached)) return cached;
+
+		ImGuiWindow* found = nullptr;
+		for (ImGuiWindow* w : g.Windows)
+			if (begunByPane(w) && (!found || w->BeginOrderWithinContext < found->BeginOrderWithinContext)) found = w;
+		return found;
+	}
+
+	bool PaneRefreshCache::NeedsRefresh(ImGuiWindow* window, const ImVec2& pos, const ImVec2& size) {
+		ImGuiContext& g = *GImGui;
+		if (window->Collapsed) return true;
+		if (pos.x != m_pos.x || pos.y != m_pos.y || size.x != m_size.x || size.y != m_size.y) return true;
+		if (!(g.IO.Fonts->TexRef == m_fontTex)) return true;
+		if (g.ActiveIdWindow && g.ActiveIdWindow->RootWindow == window) return true;
+
+		switch (m_policy) {
+		case PaneRefresh_FixedRate:
+			return m_rateHz <= 0.f || ImGui::GetTime() - m_lastRefreshTime >= 1.0 / m_rateHz;
+		case PaneRefresh_WhileInteracting: {
+			// one extra refresh after the mouse leaves clears the hover visuals
+			const bool interacting = ImGui::IsMouseHoveringRect(pos, ImVec2(pos.x + size.x, pos.y + size.y), false);
+			const bool refresh = interacting || m_wasInteracting;
+			m_wasInteracting = interacting;
+			return refresh;
+		}
+		case PaneRefresh_OnInvalidate:
+		default:
+			return false;
+		}
+	}
+
+	void PaneRefreshCache::Capture(ImGuiWindow* window, const ImVec2& pos, const ImVec2& size) {
+		const ImDrawList* dl = window->DrawList;
+		m_cmd.resize(dl->CmdBuffer.Size);
+		m_idx.resize(dl->IdxBuffer.Size);
+		m_vtx.resize(dl->VtxBuffer.Size);
+		memcpy(m_cmd.Data, dl->CmdBuffer.Data, (size_t)m_cmd.Size * sizeof(ImDrawCmd));
+		memcpy(m_idx.Data, dl->IdxBuffer.Data, (size_t)m_idx.Size * sizeof(ImDrawIdx));
+		memcpy(m_vtx.Data, dl->VtxBuffer.Data, (size_t)m_vtx.Size * sizeof(ImDrawVert));
+		m_cmdHeader = dl->_CmdHeader;
+		m_vtxCurrentIdx = dl->_VtxCurrentIdx;
+
+		m_windowId = window->ID;
+		m_windowFlags = window->Flags;
+		m_pos = pos;
+		m_size = size;
+		m_fontTex = GImGui->IO.Fonts->TexRef;
+		m_lastRefreshTime = ImGui::GetTime();
+		m_valid = m_cmd.Size > 0;
+	}
+
+	// Begin() keeps the window alive and resets its draw list; the captured
+	// buffers then replace what Begin() emitted before End() closes it.
+	void PaneRefreshCache::Replay(ImGuiWindow* window) {
+		ImGui::Begin(window->Name, nullptr, m_windowFlags);
+		ImDrawList* dl = window->DrawList;
+		dl->CmdBuffer.resize(m_cmd.Size);
+		dl->IdxBuffer.resize(m_idx.Size);
+		dl->VtxBuffer.resize(m_vtx.Size);
+		memcpy(dl->CmdBuffer.Data, m_cmd.Data, (size_t)m_cmd.Size * sizeof(ImDrawCmd));
+		memcpy(dl->IdxBuffer.Data, m_idx.Data, (size_t)m_idx.Size * sizeof(ImDrawIdx));
+		memcpy(dl->VtxBuffer.Data, m_vtx.Data, (size_t)m_vtx.Size * sizeof(ImDrawVert));
+		dl->_CmdHeader = m_cmdHeader;
+		dl->_VtxCurrentIdx = m_vtxCurrentIdx;
+		dl->_VtxWritePtr = dl->VtxBuffer.Data + dl->VtxBuffer.Size;
+		dl->_IdxWritePtr = dl->IdxBuffer.Data + dl->IdxBuffer.Size;
+		ImGui::End();
+		m_replayed = true;
+	}
+
+	// SplitterIndex implementation
+	void SplitterIndex::Clear() {
+		m_horizontalLines.clear();
+		m_verticalLines.clear();
+	}
+
+	void SplitterIndex::Add(bool verticalSplit, float pos, float spanMin, float spanMax, int boundaryIndex, CustomLayoutNode* node, int flatNode) {
+		auto& bucket = verticalSplit ? m_horizontalLines : m_verticalLines;
+		const int order = (int)(m_horizontalLines.size() + m_verticalLines.size());
+		bucket.push_back(SplitterSegment{ pos, spanMin, spanMax, order, boundaryIndex, node, flatNode });
+	}
+
+	void SplitterIndex::Build() {
+		auto byPos = [](const SplitterSegment& a, const SplitterSegment& b) { return a.pos < b.pos; };
+		std::sort(m_horizontalLines.begin(), m_horizontalLines.end(), byPos);
+		std::sort(m_verticalLines.begin(), m_verticalLines.end(), byPos);
+	}
+
+	int SplitterIndex::Size() const { return (int)(m_horizontalLines.size() + m_verticalLines.size()); }
+
+	int SplitterIndex::LowerBound(const std::vector<SplitterSegment>& bucket, float pos) {
+		return (int)(std::lower_bound(bucket.begin(), bucket.end(), pos, [](const SplitterSegment& s, float v) { return s.pos < v; }) - bucket.begin());
+	}
+
+	// Old segments sorted by DFS order pair up with the new ones in collection
+	// order; each keeps its order, takes the new position and span, and only
+	// the patched range is re-sorted.
+	bool SplitterIndex::ApplyPatch(const SplitterIndex& subtree) {
+		for (int axis = 0; axis < 2; ++axis) {
+			std::vector<SplitterSegment>& bucket = axis ? m_verticalLines : m_horizontalLines;
+			const std::vector<SplitterSegment>& fresh = axis ? subtree.m_verticalLines : subtree.m_horizontalLines;
+			std::vector<int>& old = m_patchOld[axis];
+			if (old.size() != fresh.size()) return false;
+			std::sort(old.begin(), old.end(), [&](int a, int b) { return bucket[a].order < bucket[b].order; });
+			for (size_t k = 0; k < old.size(); ++k) {
+				const SplitterSegment& o = bucket[old[k]];
+				if (o.node != fresh[k].node || o.flatNode != fresh[k].flatNode || o.boundaryIndex != fresh[k].boundaryIndex) return false;
+			}
+		}
+		for (int axis = 0; axis < 2; ++axis) {
+			std::vector<SplitterSegment>& bucket = axis ? m_verticalLines : m_horizontalLines;
+			const std::vector<SplitterSegment>& fresh = axis ? subtree.m_verticalLines : subtree.m_horizontalLines;
+			for (size_t k = 0; k < m_patchOld[axis].size(); ++k) {
+				SplitterSegment& o = bucket[m_patchOld[axis][k]];
+				o.pos = fresh[k].pos;
+				o.spanMin = fresh[k].spanMin;
+				o.spanMax = fresh[k].spanMax;
+			}
+			std::sort(bucket.begin() + m_patchRange[axis][0], bucket.begin() + m_patchRange[axis][1],
+				[](const SplitterSegment& a, const SplitterSegment& b) { return a.pos < b.pos; });
+		}
+		return true;
+	}
+
+	// Old segments are dropped, later ones renumbered and the new ones merged
+	// in by position; sorting stays local to where they are inserted.
+	void SplitterIndex::ApplyReplace(const SplitterIndex& subtree, int first, int count) {
+		const int shift = subtree.Size() - count;
+		for (int axis = 0; axis < 2; ++axis) {
+			std::vector<SplitterSegment>& bucket = axis ? m_verticalLines : m_horizontalLines;
+			const std::vector<SplitterSegment>& fresh = axis ? subtree.m_verticalLines : subtree.m_horizontalLines;
+			for (int i : m_patchOld[axis]) bucket[i].order = -1;
+			bucket.erase(std::remove_if(bucket.begin(), bucket.end(), [](const SplitterSegment& s) { return s.order < 0; }), bucket.end());
+			for (SplitterSegment& seg : bucket) if (seg.order >= first + count) seg.order += shift;
+			for (SplitterSegment seg : fresh) {
+				seg.order += first;
+				auto at = std::upper_bound(bucket.begin(), bucket.end(), seg.pos, [](float v, const SplitterSegment& s) { return v < s.pos; });
+				bucket.insert(at, seg);
+			}
+		}
+	}
+
+	const SplitterSegment* SplitterIndex::FindInBucket(const std::vector<SplitterSegment>& bucket, float along, float across, float pad, const SplitterSegment* best) {
+		auto it = std::lower_bound(bucket.begin(), bucket.end(), along - pad,
+			[](const SplitterSegment& s, float v) { return s.pos < v; });
+		for (; it != bucket.end() && it->pos <= along + pad; ++it) {
+			if (across < it->spanMin || across > it->spanMax) continue;
+			if (!best || it->order < best->order) best = &*it;
+		}
+		return best;
+	}
+
+	// Overlapping hits resolve to the lowest DFS order, matching the
+	// parent-first result of CustomLayoutNode::FindHoveredSplitter.
+	const SplitterSegment* SplitterIndex::Find(const ImVec2& mousePos, float pad) const {
+		const SplitterSegment* best = FindInBucket(m_horizontalLines, mousePos.y, mousePos.x, pad, nullptr);
+		return FindInBucket(m_verticalLines, mousePos.x, mousePos.y, pad, best);
+	}
 
 	// CustomLayout implementation
 	CustomLayout::CustomLayout(CustomLayoutNode* root) : m_root(root) {
 		assert(root != nullptr && "Root must not be null");
 		m_activeBoundaryIndex = -1;
+		m_treeView = new LayoutTreeView(root);
+	}
+
+	CustomLayout::CustomLayout(FlatLayoutTree* tree) : m_flat(tree) {
+		assert(tree != nullptr && tree->NodeCount() > 0 && "Flat tree must not be empty");
+		m_activeBoundaryIndex = -1;
+		m_treeView = new LayoutTreeView(tree);
+	}
+
+	CustomLayout::~CustomLayout() {
+		if (m_iniSettings) LayoutSnapshot::UnregisterIniSettings(this);
+		delete m_root; delete m_flat;
+		delete m_prepareWorkers;
+		delete m_treeView;
+	}
+
+	void CustomLayout::EnableIniSettings(const char* name) {
+		assert(m_root != nullptr && "Ini settings are only supported for CustomLayoutNode trees");
+		LayoutSnapshot::RegisterIniSettings(this, name);
+		m_iniSettings = true;
+	}
+
+	void CustomLayout::EnablePaneProfiling(bool enable) {
+		assert(m_root != nullptr && "Pane profiling is only supported for CustomLayoutNode trees");
+		m_profilePanes = enable;
+	}
+	bool CustomLayout::IsPaneProfilingEnabled() const { return m_profilePanes; }
+
+	void CustomLayout::SetPaneBudget(float cpuUs, int vertices) {
+		m_budgetCpuUs = cpuUs;
+		m_budgetVertices = vertices;
+	}
+
+	void CustomLayout::EnableParallelPrepare(bool enable, int workerCount) {
+		delete m_prepareWorkers;
+		m_prepareWorkers = nullptr;
+		if (enable) m_prepareWorkers = new PaneWorkerPool(workerCount > 0 ? workerCount : PaneWorkerPool::DefaultWorkerCount());
+	}
+	bool CustomLayout::IsParallelPrepareEnabled() const { return m_prepareWorkers != nullptr; }
+
+	void CustomLayout::PreparePanes() {
+		if (m_prepareJobs.empty()) return;
+		const float dt = ImGui::GetIO().DeltaTime;
+		if (m_prepareWorkers) m_prepareWorkers->Run(m_prepareJobs.data(), (int)m_prepareJobs.size(), dt);
+		else for (PanePrepareJob& job : m_prepareJobs) job.func->Prepare(dt, job.rect);
+	}
+
+	void CustomLayout::SetHiddenCompactDelay(float seconds) { m_hiddenCompactDelay = seconds; }
+	float CustomLayout::GetHiddenCompactDelay() const { return m_hiddenCompactDelay; }
+	const LayoutMemoryStats& CustomLayout::GetMemoryStats() const { return m_memoryStats; }
+
+	// One sweep per second over all panes; a pane that is submitted again
+	// regrows its buffers on its own.
+	void CustomLayout::CompactHiddenPanes() {
+		m_compactSweepTime += ImGui::GetIO().DeltaTime;
+		if (m_compactSweepTime < 1.f || m_hiddenCompactDelay < 0.f) return;
+		m_compactSweepTime = 0.f;
+		const size_t total = m_memoryStats.TotalReleased;
+		m_memoryStats = LayoutMemoryStats();
+		m_root->CompactHiddenPanes(ImGui::GetTime() - m_hiddenCompactDelay, m_memoryStats);
+		const size_t freed = m_memoryStats.BytesBefore > m_memoryStats.BytesAfter ? m_memoryStats.BytesBefore - m_memoryStats.BytesAfter : 0;
+		m_memoryStats.TotalReleased = total + freed + m_memoryStats.HookBytes;
 	}
 
-	CustomLayout::~CustomLayout() { delete m_root; }
+	void CustomLayout::ReleaseTransientBuffers() {
+		if (m_root) m_root->ReleaseTransientBuffers();
+		std::vector<PaneCostRow>().swap(m_paneCostRows);
+		m_treeView->Release();
+	}
 
 	void CustomLayout::UpdateAndRender() {
+		UpdateRelayoutRate();
+		if (m_flat) { UpdateAndRenderFlat(); return; }
 		DrawControlPanel();
+		CustomLayoutNode* moved; CustomLayoutNode* movedTo; int movedIndex;
+		if (m_treeView->TakePendingMove(moved, movedTo, movedIndex)) MovePane(moved, movedTo, movedIndex);
 
-		ImGuiViewport* vp = ImGui::GetMainViewport();
-		m_root->ResizeNodeAndChildren(vp->WorkPos, vp->WorkSize);
-		m_lastViewportSize = vp->WorkSize;
-
+		// Hover and drag work on the geometry of the previous layout pass, so a
+		// drag only dirties the dragged splitter and the single pass below
+		// relays out that subtree.
 		ImVec2 mousePos = ImGui::GetMousePos();
 		if (!ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
 			m_activeNode = nullptr; m_activeBoundaryIndex = -1;
-			m_root->FindHoveredSplitter(mousePos, m_activeNode, m_activeBoundaryIndex);
+			if (const SplitterSegment* seg = m_splitterIndex.Find(mousePos, 8.f)) {
+				m_activeNode = seg->node; m_activeBoundaryIndex = seg->boundaryIndex;
+			}
 		}
+		// a pane being dragged never moves the splitter it was picked up over
+		if (HandlePaneDrop()) { m_activeNode = nullptr; m_activeBoundaryIndex = -1; }
 
 		if (m_activeNode) {
-			ImGui::SetMouseCursor(m_activeNode->IsVerticalSplitter() ? ImGuiMouseCursor_ResizeNS : ImGuiMouseCursor_ResizeEW);
+			ImGui::SetMouseCursor(m_activeNode->IsVerticalBoundary(m_activeBoundaryIndex) ? ImGuiMouseCursor_ResizeNS : ImGuiMouseCursor_ResizeEW);
 		}
 
+		// a drag into an otherwise clean tree only relays out the dragged subtree;
+		// at the root that is the whole tree and the full pass is cheaper
+		const bool cleanBeforeDrag = !m_root->IsGeometryDirty();
+		bool dragged = false;
 		if (ImGui::IsMouseDragging(ImGuiMouseButton_Left) && m_activeNode) {
 			ImVec2 delta = ImGui::GetMouseDragDelta();
 			if (m_activeNode->HandleSplitterDragAt(m_activeBoundaryIndex, delta)) {
 				ImGui::ResetMouseDragDelta();
-				ImGuiViewport* vp2 = ImGui::GetMainViewport();
-				m_root->ResizeNodeAndChildren(vp2->WorkPos, vp2->WorkSize);
+				dragged = true;
 			}
 		}
 
+		ImGuiViewport* vp = ImGui::GetMainViewport();
+		if (m_iniSettings && m_root->IsGeometryDirty()) ImGui::MarkIniSettingsDirty();
+		if (dragged && cleanBeforeDrag && m_activeNode != m_root && !ViewportChanged(vp)) {
+			m_activeNode->RelayoutSubtree();
+			if (!PatchDraggedSubtree()) RebuildLayoutCaches();
+			CountRelayout();
+		}
+		else if (m_root->IsGeometryDirty() || ViewportChanged(vp)) {
+			m_root->ResizeNodeAndChildren(vp->WorkPos, vp->WorkSize);
+			m_lastViewportPos = vp->WorkPos;
+			m_lastViewportSize = vp->WorkSize;
+			RebuildLayoutCaches();
+			CountRelayout();
+		}
+
+		PreparePanes();
+		m_root->RenderPanes(m_profilePanes);
+		UpdatePaneDragSource();
 		m_root->RenderNodeAndChildren();
+		CompactHiddenPanes();
+	}
+
+	// The preview only draws; the tree is edited once, on release, so the drag
+	// itself never relays out. A payload dropped on the tree view is delivered
+	// there instead.
+	bool CustomLayout::HandlePaneDrop() {
+		const ImGuiPayload* payload = ImGui::GetDragDropPayload();
+		if (!payload || !payload->IsDataType(PaneDragPayload) || payload->Delivery) return false;
+		CustomLayoutNode* dragged;
+		memcpy(&dragged, payload->Data, sizeof(dragged));
+		if (!m_root->IsAncestorOf(dragged)) return false;
+
+		ImGuiContext& g = *GImGui;
+		if (g.HoveredWindow && g.HoveredWindow->RootWindow == m_panelWindow) return true;
+		CustomLayoutNode* parent; int index; ImRect preview;
+		if (!FindPaneDropTarget(ImGui::GetMousePos(), dragged, parent, index, preview)) return true;
+		if (ImGui::IsMouseReleased(g.DragDropMouseButton)) {
+			MovePane(dragged, parent, index);
+			return true;
+		}
+		ImDrawList* dl = ImGui::GetForegroundDrawList();
+		dl->AddRectFilled(preview.Min, preview.Max, ImGui::GetColorU32(ImGuiCol_DragDropTarget, 0.3f));
+		dl->AddRect(preview.Min, preview.Max, ImGui::GetColorU32(ImGuiCol_DragDropTarget), 0.f, 0, 2.f);
+		return true;
+	}
+
+	// Shift-dragging the title bar of a pane picks it up like its tree view
+	// row. The drag source is an item appended to the pane's window over the
+	// title bar, so ImGui does not start moving the window; it is submitted
+	// for the pane under the mouse and, until the drag ends, for the dragged one.
+	void CustomLayout::UpdatePaneDragSource() {
+		ImGuiContext& g = *GImGui;
+		CustomLayoutNode* pane = m_titleDragPane;
+		if (!pane) {
+			if (!g.IO.KeyShift || (g.ActiveId != 0 && !g.IO.MouseClicked[ImGuiMouseButton_Left])) return;
+			pane = m_root->FindPaneAt(g.IO.MousePos);
+			if (!pane) return;
+		}
+		ImGuiWindow* window = ImGui::FindWindowByID(pane->GetPaneCache().GetWindowId());
+		if (!window || window->LastFrameActive != g.FrameCount || (window->Flags & ImGuiWindowFlags_NoTitleBar)) {
+			m_titleDragPane = nullptr;
+			return;
+		}
+
+		ImGui::Begin(window->Name);   // appends to the pane's window
+		const ImRect title = window->TitleBarRect();
+		const ImGuiID id = window->GetID("##PaneDragSource");
+		ImGui::PushClipRect(title.Min, title.Max, false);
+		if (ImGui::ItemAdd(title, id)) {
+			bool hovered, held;
+			ImGui::ButtonBehavior(title, id, &hovered, &held);
+			if (ImGui::BeginDragDropSource()) {
+				ImGui::SetDragDropPayload(PaneDragPayload, &pane, sizeof(pane));
+				ImGui::TextUnformatted(pane->GetLabel().c_str());
+				ImGui::EndDragDropSource();
+			}
+		}
+		ImGui::PopClipRect();
+		ImGui::End();
+		m_titleDragPane = g.ActiveId == id ? pane : nullptr;
+	}
+
+	// Dropping on a pane inserts before or after it in its parent, depending on
+	// which half along the parent's axis is under the mouse. Dropping on the
+	// page of a tab container adds the pane as its last tab.
+	bool CustomLayout::FindPaneDropTarget(const ImVec2& mouse, const CustomLayoutNode* dragged, CustomLayoutNode*& outParent, int& outIndex, ImRect& outPreview) {
+		CustomLayoutNode* target = m_root->FindPaneAt(mouse);
+		if (!target || target == dragged || !target->GetParent()) return false;
+		CustomLayoutNode* parent = target->GetParent();
+		const ImVec2 p = target->GetDomainPos(), s = target->GetDomainSize();
+		if (parent->IsGrid()) return false;
+		if (parent->IsTabContainer()) {
+			if (dragged->GetParent() == parent) return false;
+			outParent = parent;
+			outIndex = (int)parent->GetChildren().size();
+			outPreview = ImRect(p, ImVec2(p.x + s.x, p.y + s.y));
+			ImRect clip;
+			if (target->AncestorScrollClip(clip)) outPreview.ClipWithFull(clip);
+			return true;
+		}
+		const bool vertical = parent->IsVerticalSplitter() || parent->IsScrollContainer();
+		const bool after = vertical ? mouse.y >= p.y + s.y * 0.5f : mouse.x >= p.x + s.x * 0.5f;
+		const int index = parent->IndexOfChild(target) + (after ? 1 : 0);
+		if (dragged->GetParent() == parent) {
+			const int from = parent->IndexOfChild(dragged);
+			if (index == from || index == from + 1) return false;
+		}
+		outParent = parent;
+		outIndex = index;
+		if (vertical) {
+			const float y = after ? p.y + s.y * 0.5f : p.y;
+			outPreview = ImRect(p.x, y, p.x + s.x, y + s.y * 0.5f);
+		}
+		else {
+			const float x = after ? p.x + s.x * 0.5f : p.x;
+			outPreview = ImRect(x, p.y, x + s.x * 0.5f, p.y + s.y);
+		}
+		ImRect clip;
+		if (target->AncestorScrollClip(clip)) outPreview.ClipWithFull(clip);
+		return true;
+	}
+
+	void CustomLayout::UpdateAndRenderFlat() {
+		DrawFlatControlPanel();
+
+		ImVec2 mousePos = ImGui::GetMousePos();
+		if (!ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+			m_activeFlatNode = -1; m_activeBoundaryIndex = -1;
+			if (const SplitterSegment* seg = m_splitterIndex.Find(mousePos, 8.f)) {
+				m_activeFlatNode = seg->flatNode; m_activeBoundaryIndex = seg->boundaryIndex;
+			}
+		}
+
+		if (m_activeFlatNode >= 0) {
+			ImGui::SetMouseCursor(m_flat->IsVerticalSplitter(m_activeFlatNode) ? ImGuiMouseCursor_ResizeNS : ImGuiMouseCursor_ResizeEW);
+		}
+
+		const bool cleanBeforeDrag = !m_flat->IsGeometryDirty();
+		bool dragged = false;
+		if (ImGui::IsMouseDragging(ImGuiMouseButton_Left) && m_activeFlatNode >= 0) {
+			ImVec2 delta = ImGui::GetMouseDragDelta();
+			if (m_flat->HandleSplitterDragAt(m_activeFlatNode, m_activeBoundaryIndex, delta)) {
+				ImGui::ResetMouseDragDelta();
+				dragged = true;
+			}
+		}
+
+		ImGuiViewport* vp = ImGui::GetMainViewport();
+		if (dragged && cleanBeforeDrag && m_activeFlatNode != 0 && !ViewportChanged(vp)) {
+			m_flat->LayoutSubtree(m_activeFlatNode);
+			if (!PatchDraggedSubtree()) RebuildLayoutCaches();
+			CountRelayout();
+		}
+		else if (m_flat->IsGeometryDirty() || ViewportChanged(vp)) {
+			m_flat->Layout(vp->WorkPos, vp->WorkSize);
+			m_lastViewportPos = vp->WorkPos;
+			m_lastViewportSize = vp->WorkSize;
+			RebuildLayoutCaches();
+			CountRelayout();
+		}
+
+		PreparePanes();
+		m_flat->RenderPanes();
+		m_flat->RenderSplitters();
+	}
+
+	bool CustomLayout::ViewportChanged(const ImGuiViewport* vp) const {
+		return vp->WorkPos.x != m_lastViewportPos.x || vp->WorkPos.y != m_lastViewportPos.y ||
+			vp->WorkSize.x != m_lastViewportSize.x || vp->WorkSize.y != m_lastViewportSize.y;
+	}
+
+	void CustomLayout::CountRelayout() {
+		++m_relayoutCount;
+		++m_relayoutsInWindow;
+	}
+
+	void CustomLayout::UpdateRelayoutRate() {
+		m_relayoutWindowTime += ImGui::GetIO().DeltaTime;
+		if (m_relayoutWindowTime < 1.f) return;
+		m_relayoutsPerSecond = m_relayoutsInWindow / m_relayoutWindowTime;
+		m_relayoutsInWindow = 0;
+		m_relayoutWindowTime = 0.f;
+	}
+
+	int CustomLayout::GetRelayoutCount() const { return m_relayoutCount; }
+	float CustomLayout::GetRelayoutsPerSecond() const { return m_relayoutsPerSecond; }
+
+	void CustomLayout::RebuildSplitterIndex() {
+		m_splitterIndex.Clear();
+		if (m_flat) m_flat->CollectSplitters(m_splitterIndex);
+		else m_root->CollectSplitters(m_splitterIndex);
+		m_splitterIndex.Build();
+	}
+
+	void CustomLayout::RebuildLayoutCaches() {
+		RebuildSplitterIndex();
+		m_prepareJobs.clear();
+		if (m_flat) m_flat->CollectPrepareJobs(m_prepareJobs);
+		else m_root->CollectPrepareJobs(m_prepareJobs);
+	}
+
+	// After a drag only the dragged subtree moved: its splitter segments and
+	// prepare rects are updated in place. Returns false when its shape changed
+	// too (a scroll container inside it now shows other children), in which
+	// case both caches need a full rebuild.
+	bool CustomLayout::PatchDraggedSubtree() {
+		m_subtreeSplitters.Clear();
+		m_subtreeJobs.clear();
+		if (m_flat) {
+			const int node = m_activeFlatNode;
+			const FlatLayoutTree* flat = m_flat;
+			m_flat->CollectSubtreeSplitters(m_subtreeSplitters);
+			const ImVec2 p = flat->GetDomainPos(node), s = flat->GetDomainSize(node);
+			if (!m_splitterIndex.Patch(m_subtreeSplitters, ImRect(p, ImVec2(p.x + s.x, p.y + s.y)),
+				[flat, node](const SplitterSegment& seg) { return seg.flatNode >= 0 && flat->IsInSubtree(node, seg.flatNode); }))
+				return false;
+			// visibility did not change, so the subtree has the same jobs
+			m_flat->UpdateSubtreePrepareRects(m_prepareJobs);
+			return true;
+		}
+
+		const CustomLayoutNode* node = m_activeNode;
+		const int begin = node->GetPrepareJobBegin(), end = node->GetPrepareJobEnd();
+		m_activeNode->CollectPrepareJobs(m_subtreeJobs, begin);
+		if ((int)m_subtreeJobs.size() != end - begin || end > (int)m_prepareJobs.size()) return false;
+		for (int i = 0; i < end - begin; ++i)
+			if (m_prepareJobs[begin + i].func != m_subtreeJobs[i].func) return false;
+
+		node->CollectSplitters(m_subtreeSplitters);
+		const ImVec2 p = node->GetDomainPos(), s = node->GetDomainSize();
+		if (!m_splitterIndex.Patch(m_subtreeSplitters, ImRect(p, ImVec2(p.x + s.x, p.y + s.y)),
+			[node](const SplitterSegment& seg) { return seg.node && node->IsAncestorOf(seg.node); }))
+			return false;
+		std::copy(m_subtreeJobs.begin(), m_subtreeJobs.end(), m_prepareJobs.begin() + begin);
+		return true;
+	}
+
+	// True if node comes before the subtree under root in a preorder walk, so
+	// its splitter segments are collected ahead of the subtree's.
+	static bool PrecedesSubtree(const CustomLayoutNode* node, const CustomLayoutNode* root) {
+		if (root->IsAncestorOf(node)) return false;
+		if (node->IsAncestorOf(root)) return true;
+		int nodeDepth = 0, rootDepth = 0;
+		for (const CustomLayoutNode* n = node->GetParent(); n; n = n->GetParent()) ++nodeDepth;
+		for (const CustomLayoutNode* n = root->GetParent(); n; n = n->GetParent()) ++rootDepth;
+		for (; nodeDepth > rootDepth; --nodeDepth) node = node->GetParent();
+		for (; rootDepth > nodeDepth; --rootDepth) root = root->GetParent();
+		while (node->GetParent() != root->GetParent()) { node = node->GetParent(); root = root->GetParent(); }
+		return node->GetParent()->IndexOfChild(node) < node->GetParent()->IndexOfChild(root);
+	}
+
+	// A move edits the children of two nodes. If the tree was clean and both
+	// were on screen, only the smallest subtrees around them whose rects stay
+	// the same are relaid out, and their splitter segments and prepare jobs
+	// are replaced in place; otherwise the next pass relays out the whole tree.
+	void CustomLayout::MovePane(CustomLayoutNode* node, CustomLayoutNode* parent, int index) {
+		CustomLayoutNode* from = node->GetParent();
+		const bool scoped = from && !m_root->IsGeometryDirty() && !ViewportChanged(ImGui::GetMainViewport()) &&
+			from->IsLaidOut() && parent->IsLaidOut();
+		if (!node->MoveTo(parent, index)) return;
+		if (m_iniSettings) ImGui::MarkIniSettingsDirty();
+		if (!scoped) return;
+
+		// both roots are found before either relayout refreshes the visibility
+		CustomLayoutNode* a = from->FindEditRelayoutRoot();
+		CustomLayoutNode* b = parent->FindEditRelayoutRoot();
+		if (a->IsAncestorOf(b)) b = nullptr;
+		else if (b->IsAncestorOf(a)) { a = b; b = nullptr; }
+		if (a == m_root) return;
+		a->RelayoutSubtree();
+		if (b) b->RelayoutSubtree();
+		if (!PatchMovedSubtrees(node, a, b)) RebuildLayoutCaches();
+		CountRelayout();
+	}
+
+	// The moved node's old segments lie in a's area but it is now below b, so
+	// they are replaced along with a's. The prepare jobs are recollected
+	// without any layout work: the move shifts the job ranges of every node
+	// between the two subtrees, which PatchDraggedSubtree relies on.
+	bool CustomLayout::PatchMovedSubtrees(const CustomLayoutNode* moved, CustomLayoutNode* a, CustomLayoutNode* b) {
+		for (CustomLayoutNode* node : { a, b }) {
+			if (!node) continue;
+			m_subtreeSplitters.Clear();
+			node->CollectSplitters(m_subtreeSplitters);
+			const ImVec2 p = node->GetDomainPos(), s = node->GetDomainSize();
+			const CustomLayoutNode* alsoOld = node == a ? moved : nullptr;
+			if (!m_splitterIndex.Replace(m_subtreeSplitters, ImRect(p, ImVec2(p.x + s.x, p.y + s.y)),
+				[node, alsoOld](const SplitterSegment& seg) { return seg.node && (node->IsAncestorOf(seg.node) || (alsoOld && alsoOld->IsAncestorOf(seg.node))); },
+				[node](const SplitterSegment& seg) { return seg.node && PrecedesSubtree(seg.node, node); }))
+				return false;
+		}
+		m_prepareJobs.clear();
+		m_root->CollectPrepareJobs(m_prepareJobs);
+		return true;
 	}
 
 	CustomLayoutNode* CustomLayout::GetRoot() { return m_root; }
+	FlatLayoutTree* CustomLayout::GetFlatTree() { return m_flat; }
 
 	void CustomLayout::DrawControlPanel() {
+		BeginControlPanel();
+		ImGui::Checkbox("Profile panes", &m_profilePanes);
+		if (m_profilePanes) DrawPaneCostTable();
+		DrawMemoryStats();
+		ImGui::Separator();
+		m_treeView->Draw();
+		EndControlPanel();
+	}
+
+	void CustomLayout::BeginControlPanel() {
 		ImGui::SetNextWindowBgAlpha(0.9f);
 		ImGui::Begin("Layout Control", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
+		// only reorder once a pane window was focused over the panel
 		ImGuiWindow* win = ImGui::GetCurrentWindow();
-		if (win)
+		m_panelWindow = win;
+		if (GImGui->Windows.back() != win)
 			ImGui::BringWindowToDisplayFront(win);
-		ImGui::Separator();
+		ImGui::Text("Relayouts/s: %.1f", m_relayoutsPerSecond);
+	}
 
-		auto& parentnodes = m_root->GetChildren();
-		if (ImGui::BeginTabBar("TabBar", ImGuiTabBarFlags_FittingPolicyResizeDown | ImGuiTabBarFlags_Reorderable)) {
-			for (int i = 0; i < (int)parentnodes.size(); ++i) {
-				CustomLayoutNode* parentnode = parentnodes[i]; if (!parentnode) continue;
-				std::string tabName = parentnode->GetLabel().empty() ? ("" + std::to_string(i)) : parentnode->GetLabel();
-				if (ImGui::BeginTabItem(tabName.c_str())) {
-					bool parentVis = parentnode->IsVisibleFlag();
-					if (ImGui::Checkbox("BOX Visible", &parentVis)) {
-						parentnode->SetDFSVisible(parentVis);
-					}
-					if (parentnode->IsVisibleFlag()) {
-						auto& childnodes = parentnode->GetChildren();
-						for (int c = 0; c < (int)childnodes.size(); ++c) {
-							CustomLayoutNode* childnode = childnodes[c]; if (!childnode) continue;
-							std::string label = childnode->GetLabel().empty() ? ("Child " + std::to_string(c)) : childnode->GetLabel();
-							bool v = childnode->IsVisibleFlag();
-							if (ImGui::Checkbox(label.c_str(), &v)) {
-								childnode->SetVisible(v);
-								parentnode->SetVisible(parentnode->IsEffectivelyVisible());
-							}
-						}
-					}
-					ImGui::EndTabItem();
+	void CustomLayout::EndControlPanel() {
+		if (m_panelCallback) m_panelCallback(m_panelCallbackData);
+		ImGui::End();
+	}
+
+	void CustomLayout::SetControlPanelCallback(void (*callback)(void* userData), void* userData) {
+		m_panelCallback = callback;
+		m_panelCallbackData = userData;
+	}
+
+	void CustomLayout::CollectPaneCostRows(const CustomLayoutNode* node) {
+		if (!node || !node->IsEffectivelyVisible()) return;
+		if (node->IsWindowNode()) {
+			const PaneCostHistory& history = node->GetCostHistory();
+			if (history.Size() == 0) return;
+			PaneCostRow row{ node, history.Summarize(), history.Last().Vertices, false };
+			row.overBudget = row.summary.AvgCpuUs > m_budgetCpuUs || row.lastVertices > m_budgetVertices;
+			m_paneCostRows.push_back(row);
+			return;
+		}
+		if (node->IsTabContainer()) {
+			const int active = node->GetActiveTab();
+			if (active >= 0) CollectPaneCostRows(node->GetChildren()[active]);
+			return;
+		}
+		if (node->IsScrollContainer()) {
+			for (int i : node->GetOnScreenChildren()) CollectPaneCostRows(node->GetChildren()[i]);
+			return;
+		}
+		for (const CustomLayoutNode* c : node->GetChildren()) CollectPaneCostRows(c);
+	}
+
+	enum PaneCostColumn { PaneCostColumn_Pane, PaneCostColumn_AvgCpu, PaneCostColumn_P99Cpu, PaneCostColumn_Vertices, PaneCostColumn_Indices, PaneCostColumn_Commands };
+
+	static float PaneCostSortKey(const PaneCostSummary& s, ImGuiID column) {
+		switch (column) {
+		case PaneCostColumn_P99Cpu:   return s.P99CpuUs;
+		case PaneCostColumn_Vertices: return s.AvgVertices;
+		case PaneCostColumn_Indices:  return s.AvgIndices;
+		case PaneCostColumn_Commands: return s.AvgCommands;
+		default:                      return s.AvgCpuUs;
+		}
+	}
+
+	// Rows are rebuilt and sorted every frame the table is shown; the row
+	// vector keeps its capacity, so this does not allocate in steady state.
+	void CustomLayout::DrawPaneCostTable() {
+		ImGui::SetNextItemWidth(100.f);
+		ImGui::DragFloat("Budget us", &m_budgetCpuUs, 10.f, 0.f, 1e6f, "%.0f");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(100.f);
+		ImGui::DragInt("Budget vtx", &m_budgetVertices, 100.f, 0, 1 << 30);
+
+		m_paneCostRows.clear();
+		CollectPaneCostRows(m_root);
+		int over = 0;
+		for (const PaneCostRow& row : m_paneCostRows) over += row.overBudget ? 1 : 0;
+		ImGui::Text("%d panes, %d over budget (last %d frames)", (int)m_paneCostRows.size(), over, PaneCostHistory::Capacity);
+
+		const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+		if (!ImGui::BeginTable("PaneCosts", 6, flags)) return;
+		ImGui::TableSetupColumn("Pane", 0, 0.f, PaneCostColumn_Pane);
+		ImGui::TableSetupColumn("Avg us", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending, 0.f, PaneCostColumn_AvgCpu);
+		ImGui::TableSetupColumn("p99 us", ImGuiTableColumnFlags_PreferSortDescending, 0.f, PaneCostColumn_P99Cpu);
+		ImGui::TableSetupColumn("Vtx", ImGuiTableColumnFlags_PreferSortDescending, 0.f, PaneCostColumn_Vertices);
+		ImGui::TableSetupColumn("Idx", ImGuiTableColumnFlags_PreferSortDescending, 0.f, PaneCostColumn_Indices);
+		ImGui::TableSetupColumn("Cmds", ImGuiTableColumnFlags_PreferSortDescending, 0.f, PaneCostColumn_Commands);
+		ImGui::TableHeadersRow();
+
+		ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+		if (specs && specs->SpecsCount > 0) {
+			const ImGuiTableColumnSortSpecs spec = specs->Specs[0];
+			const bool ascending = spec.SortDirection == ImGuiSortDirection_Ascending;
+			std::sort(m_paneCostRows.begin(), m_paneCostRows.end(), [&](const PaneCostRow& a, const PaneCostRow& b) {
+				if (spec.ColumnUserID == PaneCostColumn_Pane) {
+					const int c = a.node->GetLabel().compare(b.node->GetLabel());
+					return ascending ? c < 0 : c > 0;
 				}
-			}
-			ImGui::EndTabBar();
+				const float ka = PaneCostSortKey(a.summary, spec.ColumnUserID);
+				const float kb = PaneCostSortKey(b.summary, spec.ColumnUserID);
+				return ascending ? ka < kb : ka > kb;
+			});
 		}
-		ImGui::End();
+
+		for (const PaneCostRow& row : m_paneCostRows) {
+			ImGui::TableNextRow();
+			if (row.overBudget) ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, IM_COL32(160, 40, 40, 160));
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(row.node->GetLabel().c_str());
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", row.summary.AvgCpuUs);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", row.summary.P99CpuUs);
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", row.summary.AvgVertices);
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", row.summary.AvgIndices);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", row.summary.AvgCommands);
+		}
+		ImGui::EndTable();
+	}
+
+	void CustomLayout::DrawMemoryStats() {
+		const LayoutMemoryStats& s = m_memoryStats;
+		ImGui::Text("Pane memory: %.1f KB -> %.1f KB, %d/%d hidden panes compacted", s.BytesBefore / 1024.f, s.BytesAfter / 1024.f, s.CompactedPanes, s.Panes);
+		ImGui::Text("Released: %.1f KB since start", s.TotalReleased / 1024.f);
+		ImGui::SetNextItemWidth(100.f);
+		ImGui::DragFloat("Compact hidden (s)", &m_hiddenCompactDelay, 1.f, -1.f, 3600.f, m_hiddenCompactDelay < 0.f ? "never" : "%.0f");
+	}
+
+	void CustomLayout::DrawFlatControlPanel() {
+		BeginControlPanel();
+		ImGui::Separator();
+		m_treeView->Draw();
+		EndControlPanel();
 	}
 
-} // namespace FrameGUILayout
\ No newline at end of file
+} // namespace FrameGUILayout
@@ -17,6 +17,13 @@
 #include <string>
 #include <cassert>
 #include <algorithm>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <new>
+#include <cfloat>
+#include <climits>
 #include "imgui.h"
 #include "implot.h"
 
@@ -24,7 +31,12 @@ using CustomWindowFunc = void (*)();
 
 namespace FrameGUILayout {
 
-	// utility structure for realtime plot
+	class CustomLayoutNode;
+	class SplitterIndex;
+
+	// utility structure for realtime plot; interleaved float ring with a wrap
+	// offset. StreamingBuffer (FrameGUIStreamBuffers.h) keeps double precision
+	// and contiguous columns for long-running streams.
 struct ScrollingBuffer {
     int MaxSize;
     int Offset;
@@ -48,9 +60,17 @@ struct ScrollingBuffer {
             Offset  = 0;
         }
     }
+    // Frees the storage; returns the bytes released.
+    size_t Release() {
+        size_t bytes = (size_t)Data.Capacity * sizeof(ImVec2);
+        Data.clear();
+        Offset = 0;
+        return bytes;
+    }
 };
 
-// utility structure for realtime plot
+// utility structure for realtime plot; restarts every span and grows with the
+// input rate. SweepBuffer (FrameGUIStreamBuffers.h) is the fixed-size version.
 struct RollingBuffer {
     float Span;
     ImVector<ImVec2> Data;
@@ -64,48 +84,538 @@ struct RollingBuffer {
             Data.shrink(0);
         Data.push_back(ImVec2(xmod, y));
     }
+    size_t Release() {
+        size_t bytes = (size_t)Data.Capacity * sizeof(ImVec2);
+        Data.clear();
+        return bytes;
+    }
 };
 
 
+	// A pane functor that also has a member
+	//   void Prepare(float dt, const ImRect& rect)
+	// is a two-phase pane: Prepare does the data work (decimation, statistics,
+	// buffer updates) for the pane's rect and may run on a worker thread, so it
+	// must not touch ImGui; operator() is the submit phase and only issues the
+	// ImGui/ImPlot calls on the UI thread.
+	template <typename T, typename = void>
+	struct HasPanePrepare : std::false_type {};
+	template <typename T>
+	struct HasPanePrepare<T, std::void_t<decltype(std::declval<T&>().Prepare(0.f, std::declval<const ImRect&>()))>> : std::true_type {};
+
+	// A pane functor with a member Compact() frees its own buffers when the
+	// layout compacts the hidden pane (see CustomLayout::SetHiddenCompactDelay).
+	// If Compact() returns a byte count it is added to the memory stats.
+	template <typename T, typename = void>
+	struct HasPaneCompact : std::false_type {};
+	template <typename T>
+	struct HasPaneCompact<T, std::void_t<decltype(std::declval<T&>().Compact())>> : std::true_type {};
+
+	// Type-erased pane window function stored inline. Holds a plain function
+	// pointer or any copyable callable (lambda, functor with per-pane state) of
+	// up to InlineSize bytes; it never allocates and larger callables fail to
+	// compile. Calling it is one indirect call, like a function pointer.
+	class PaneCallable {
+	public:
+		static constexpr size_t InlineSize = 128;
+
+		PaneCallable() = default;
+		PaneCallable(std::nullptr_t) {}
+
+		template <typename F, typename T = std::decay_t<F>,
+			typename = std::enable_if_t<!std::is_same<T, PaneCallable>::value && std::is_invocable<T&>::value>>
+		PaneCallable(F&& func) {
+			static_assert(sizeof(T) <= InlineSize, "Pane callable exceeds PaneCallable::InlineSize; keep bulky state behind a pointer");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Pane callable is over-aligned");
+			static_assert(std::is_copy_constructible<T>::value, "Pane callables must be copyable");
+			if constexpr (std::is_pointer<T>::value) { if (!func) return; }
+			::new (static_cast<void*>(m_storage)) T(std::forward<F>(func));
+			m_invoke = &Model<T>::Invoke;
+			if constexpr (HasPanePrepare<T>::value) m_prepare = &Model<T>::Prepare;
+			if constexpr (HasPaneCompact<T>::value) m_compact = &Model<T>::Compact;
+			m_ops = &Model<T>::Table;
+		}
+
+		PaneCallable(const PaneCallable& other) { CopyFrom(other); }
+		PaneCallable(PaneCallable&& other) noexcept { MoveFrom(other); }
+		PaneCallable& operator=(const PaneCallable& other) { if (this != &other) { Reset(); CopyFrom(other); } return *this; }
+		PaneCallable& operator=(PaneCallable&& other) noexcept { if (this != &other) { Reset(); MoveFrom(other); } return *this; }
+		~PaneCallable() { Reset(); }
+
+		void operator()() const { m_invoke(const_cast<unsigned char*>(m_storage)); }
+		explicit operator bool() const { return m_invoke != nullptr; }
+
+		// Prepare phase of a two-phase pane; a no-op for plain callables.
+		bool HasPrepare() const { return m_prepare != nullptr; }
+		void Prepare(float dt, const ImRect& rect) { if (m_prepare) m_prepare(m_storage, dt, rect); }
+
+		// Compact hook of the stored callable; returns the bytes it reported.
+		size_t Compact() { return m_compact ? m_compact(m_storage) : 0; }
+
+		// The stored callable, or nullptr if it is not a T.
+		template <typename T> T* Target() { return m_ops == &Model<T>::Table ? std::launder(reinterpret_cast<T*>(m_storage)) : nullptr; }
+		template <typename T> const T* Target() const { return m_ops == &Model<T>::Table ? std::launder(reinterpret_cast<const T*>(m_storage)) : nullptr; }
+
+		void Reset() {
+			if (!m_ops) return;
+			m_ops->destroy(m_storage);
+			m_ops = nullptr;
+			m_invoke = nullptr;
+			m_prepare = nullptr;
+			m_compact = nullptr;
+		}
+
+	private:
+		struct Ops {
+			void (*copy)(void* dst, const void* src);
+			void (*move)(void* dst, void* src);
+			void (*destroy)(void* p);
+		};
+
+		template <typename T>
+		struct Model {
+			static void Invoke(void* p) { (*static_cast<T*>(p))(); }
+			static void Prepare(void* p, float dt, const ImRect& rect) { static_cast<T*>(p)->Prepare(dt, rect); }
+			static size_t Compact(void* p) {
+				if constexpr (std::is_convertible<decltype(std::declval<T&>().Compact()), size_t>::value) return static_cast<T*>(p)->Compact();
+				else { static_cast<T*>(p)->Compact(); return 0; }
+			}
+			static void Copy(void* dst, const void* src) { ::new (dst) T(*static_cast<const T*>(src)); }
+			static void Move(void* dst, void* src) { ::new (dst) T(std::move(*static_cast<T*>(src))); }
+			static void Destroy(void* p) { static_cast<T*>(p)->~T(); }
+			static constexpr Ops Table{ &Copy, &Move, &Destroy };
+		};
+
+		void CopyFrom(const PaneCallable& other) {
+			if (!other.m_ops) return;
+			other.m_ops->copy(m_storage, other.m_storage);
+			m_invoke = other.m_invoke;
+			m_prepare = other.m_prepare;
+			m_compact = other.m_compact;
+			m_ops = other.m_ops;
+		}
+		void MoveFrom(PaneCallable& other) {
+			if (!other.m_ops) return;
+			other.m_ops->move(m_storage, other.m_storage);
+			m_invoke = other.m_invoke;
+			m_prepare = other.m_prepare;
+			m_compact = other.m_compact;
+			m_ops = other.m_ops;
+			other.Reset();
+		}
+
+		void (*m_invoke)(void*) = nullptr;
+		void (*m_prepare)(void*, float, const ImRect&) = nullptr;
+		size_t (*m_compact)(void*) = nullptr;
+		const Ops* m_ops = nullptr;
+		alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+	};
+
+	// ImGui drag-and-drop payload type of a dragged window node; the payload is
+	// the CustomLayoutNode pointer.
+	constexpr const char* PaneDragPayload = "FRAMEGUI_PANE";
+
+	// Prepare call of one visible two-phase pane, collected on relayout.
+	struct PanePrepareJob {
+		PaneCallable* func;
+		ImRect rect;
+	};
+
+	enum PaneRefreshPolicy {
+		PaneRefresh_EveryFrame,        // run the window function every frame (default)
+		PaneRefresh_FixedRate,         // run it at a fixed rate, replay the cached draw list in between
+		PaneRefresh_OnInvalidate,      // run it only after Invalidate() or a geometry change
+		PaneRefresh_WhileInteracting,  // run it while the pane is hovered or has an active item
+	};
+
+	struct PaneCostSample {
+		float CpuUs;        // time spent in the window function (or its replay)
+		int Vertices;       // emitted by the pane's root window
+		int Indices;
+		int Commands;
+	};
+
+	struct PaneCostSummary {
+		int Samples = 0;
+		float AvgCpuUs = 0.f;
+		float P99CpuUs = 0.f;
+		float AvgVertices = 0.f;
+		float AvgIndices = 0.f;
+		float AvgCommands = 0.f;
+	};
+
+	// Result of one hidden-pane compaction sweep. Bytes count pane draw caches,
+	// cost samples and the draw buffers of the panes' ImGui windows.
+	struct LayoutMemoryStats {
+		int Panes = 0;
+		int CompactedPanes = 0;     // hidden panes whose memory is currently released
+		size_t BytesBefore = 0;     // before this sweep
+		size_t BytesAfter = 0;
+		size_t HookBytes = 0;       // reported by pane Compact() hooks in this sweep
+		size_t TotalReleased = 0;   // every sweep since the layout was created
+	};
+
+	// Ring buffer of the last Capacity cost samples of one pane, filled while
+	// pane profiling is enabled on the CustomLayout. Storage is reserved on the
+	// first sample, so panes that are never profiled pay nothing.
+	class PaneCostHistory {
+	public:
+		static constexpr int Capacity = 128;
+
+		void Push(const PaneCostSample& sample);
+		void Clear();
+		void Release();     // Clear() and free the storage
+		int Size() const;
+		size_t MemoryBytes() const;
+		const PaneCostSample& Last() const;
+		PaneCostSummary Summarize() const;
+
+	private:
+		ImVector<PaneCostSample> m_samples;
+		int m_next = 0;
+	};
+
+	// Replays the last captured draw list of a pane window instead of re-running
+	// its window function. Only the pane's root window is captured, so panes that
+	// open child windows should stay on PaneRefresh_EveryFrame. Any policy also
+	// refreshes on a geometry or font atlas change and while one of the pane's
+	// items is active.
+	class PaneRefreshCache {
+	public:
+		void SetPolicy(PaneRefreshPolicy policy, float rateHz = 0.f);
+		PaneRefreshPolicy GetPolicy() const;
+		void Invalidate();
+		// Frees the captured draw list and compacts the pane's ImGui window if it
+		// was not submitted this frame. The next Submit re-runs the pane.
+		void Release();
+		// Captured draw list plus the draw buffers of the pane's ImGui window.
+		size_t MemoryBytes() const;
+		// Records the callback's CPU time and draw counts into costs when given.
+		// With a clip rect the pane's window is drawn and hit-tested only inside it.
+		void Submit(const PaneCallable& func, const ImVec2& pos, const ImVec2& size, PaneCostHistory* costs = nullptr, const ImRect* clip = nullptr);
+		bool WasReplayed() const;
+		// The pane's ImGui window once it has been looked up, else 0.
+		ImGuiID GetWindowId() const;
+
+	private:
+		void SubmitTimed(const PaneCallable& func, const ImVec2& pos, const ImVec2& size, PaneCostHistory& costs);
+		void SubmitUntimed(const PaneCallable& func, const ImVec2& pos, const ImVec2& size);
+		ImGuiWindow* FindPaneWindow(int beginOrder) const;
+		bool NeedsRefresh(ImGuiWindow* window, const ImVec2& pos, const ImVec2& size);
+		void Capture(ImGuiWindow* window, const ImVec2& pos, const ImVec2& size);
+		void Replay(ImGuiWindow* window);
+
+		PaneRefreshPolicy m_policy = PaneRefresh_EveryFrame;
+		float m_rateHz = 0.f;
+		bool m_valid = false;
+		bool m_wasInteracting = false;
+		bool m_replayed = false;
+		double m_lastRefreshTime = 0.0;
+		ImGuiID m_windowId = 0;
+		ImGuiWindowFlags m_windowFlags = 0;
+		ImVec2 m_pos{ 0,0 };
+		ImVec2 m_size{ 0,0 };
+		ImTextureRef m_fontTex;
+		ImDrawCmdHeader m_cmdHeader{};
+		unsigned int m_vtxCurrentIdx = 0;
+		ImVector<ImDrawCmd> m_cmd;
+		ImVector<ImDrawIdx> m_idx;
+		ImVector<ImDrawVert> m_vtx;
+	};
+
+	// Pixel size limits of a node along its parent's split axis. A fixed size
+	// overrides min/max; flexible nodes share the remaining space by split ratio.
+	struct LayoutConstraints {
+		float MinSize = 0.f;
+		float MaxSize = FLT_MAX;
+		float FixedSize = 0.f;      // > 0: the node is exactly this size
+
+		bool IsFixed() const { return FixedSize > 0.f; }
+		bool IsDefault() const { return MinSize <= 0.f && MaxSize >= FLT_MAX && FixedSize <= 0.f; }
+		float Min() const { return IsFixed() ? FixedSize : MinSize; }
+		float Max() const { return IsFixed() ? FixedSize : MaxSize; }
+	};
+
+	// Split and drag math shared by CustomLayoutNode, FlatLayoutTree and
+	// StaticLayout. k numbers the visible children of a split in order;
+	// weight(k) is a child's split ratio and limits(k) its LayoutConstraints.
+	namespace SplitMath {
+
+		// Prefix offsets 0..1 of n children whose weights add up to sum;
+		// offsets holds n + 1 entries.
+		template <typename Weight>
+		void Offsets(int n, float sum, Weight&& weight, float* offsets) {
+			float acc = 0.f;
+			offsets[0] = 0.f;
+			for (int k = 0; k < n; ++k) {
+				acc += weight(k);
+				offsets[k + 1] = acc / sum;
+			}
+			if (n > 0) offsets[n] = 1.f;
+		}
+
+		// Unconstrained children take their edges straight from the offsets, so
+		// moving one offset leaves every other edge bit-identical.
+		inline float OffsetEdge(float start, float extent, float offset) { return start + offset * extent; }
+		inline void OffsetEdges(int n, float start, float extent, const float* offsets, float* edges) {
+			for (int k = 0; k <= n; ++k) edges[k] = OffsetEdge(start, extent, offsets[k]);
+		}
+
+		// One backward pass builds suffix sums of the children's limits, one
+		// forward pass sizes each child from its weighted share of the remaining
+		// space, clamped to its own limits and to what the children after it can
+		// still absorb. No child is revisited, so the cost is O(n) and the result
+		// depends only on the inputs. If the minimums do not fit, earlier children
+		// give way. edges holds n + 1 entries, scratch 4 * (n + 1).
+		template <typename Weight, typename Limits>
+		void SolveEdges(int n, float start, float extent, Weight&& weight, Limits&& limits, float* edges, float* scratch) {
+			float* sufMin = scratch;
+			float* sufMax = sufMin + (n + 1);
+			float* sufFixed = sufMax + (n + 1);
+			float* sufWeight = sufFixed + (n + 1);
+			sufMin[n] = sufMax[n] = sufFixed[n] = sufWeight[n] = 0.f;
+			for (int k = n - 1; k >= 0; --k) {
+				const LayoutConstraints& c = limits(k);
+				sufMin[k] = sufMin[k + 1] + c.Min();
+				sufMax[k] = sufMax[k + 1] + c.Max();
+				sufFixed[k] = sufFixed[k + 1] + (c.IsFixed() ? c.FixedSize : 0.f);
+				sufWeight[k] = sufWeight[k + 1] + (c.IsFixed() ? 0.f : weight(k));
+			}
+
+			float pos = start, rem = extent;
+			edges[0] = start;
+			for (int k = 0; k < n; ++k) {
+				const LayoutConstraints& c = limits(k);
+				float size;
+				if (c.IsFixed()) size = c.FixedSize;
+				else {
+					const float flexible = rem - sufFixed[k + 1];
+					size = sufWeight[k] > 0.f ? flexible * (weight(k) / sufWeight[k]) : 0.f;
+					size = ImClamp(size, c.MinSize, c.MaxSize);
+				}
+				size = ImMin(size, rem - sufMin[k + 1]);
+				size = ImMax(size, rem - sufMax[k + 1]);
+				size = ImClamp(size, 0.f, ImMax(rem, 0.f));
+				pos += size;
+				rem -= size;
+				edges[k + 1] = pos;
+			}
+			edges[n] = start + extent;
+		}
+
+		// Moves the boundary between neighbours a (sizeA pixels) and b (pair -
+		// sizeA) by delta pixels, limited by both constraints, and splits their
+		// combined weight in the new proportion, so no other child changes.
+		// Returns false if the boundary did not move.
+		inline bool DragBoundary(float sizeA, float pair, const LayoutConstraints& a, const LayoutConstraints& b,
+			float delta, float& weightA, float& weightB) {
+			if (delta == 0.f || pair <= 1e-6f || a.IsFixed() || b.IsFixed()) return false;
+			const float lo = ImMax(a.MinSize, pair - b.MaxSize);
+			const float hi = ImMin(a.MaxSize, pair - b.MinSize);
+			if (lo > hi) return false;
+			const float newA = ImClamp(sizeA + delta, lo, hi);
+			if (newA == sizeA) return false;
+			const float pairWeight = weightA + weightB;
+			weightA = pairWeight * (newA / pair);
+			weightB = pairWeight - weightA;
+			return true;
+		}
+
+	} // namespace SplitMath
+
+	enum LayoutNodeKind {
+		LayoutNode_Split,   // divides its area between all visible children (horizontal unless built with isVertical)
+		LayoutNode_Tabs,    // shows only the active child, below a tab bar
+		LayoutNode_Grid,    // places children on shared column and row tracks
+		LayoutNode_Scroll,  // stacks children vertically at their own extent and scrolls them
+	};
+
+	// Indices into a node's children.
+	struct ChildIndexSpan {
+		const int* First;
+		const int* Last;
+		const int* begin() const { return First; }
+		const int* end() const { return Last; }
+	};
+
+	// Column or row of a grid node: a weighted share of the free space, never
+	// less than MinSize pixels.
+	struct GridTrack {
+		float Weight = 1.f;
+		float MinSize = 0.f;
+	};
+
+	// Tracks covered by a grid child.
+	struct GridCell {
+		int Col = 0;
+		int Row = 0;
+		int ColSpan = 1;
+		int RowSpan = 1;
+
+		bool Overlaps(const GridCell& o) const {
+			return Col < o.Col + o.ColSpan && o.Col < Col + ColSpan && Row < o.Row + o.RowSpan && o.Row < Row + RowSpan;
+		}
+	};
 
 	class CustomLayoutNode {
 	public:
 		CustomLayoutNode(bool isVertical, const char* label = nullptr);
-		CustomLayoutNode(CustomWindowFunc func, const char* label);
+		explicit CustomLayoutNode(LayoutNodeKind kind, const char* label = nullptr);
+		CustomLayoutNode(PaneCallable func, const char* label);
+
+		// Window node from a function pointer, lambda or stateful functor; the
+		// callable and its state are stored inline in the node.
+		template <typename F, typename = std::enable_if_t<
+			!std::is_same<std::decay_t<F>, PaneCallable>::value && std::is_invocable<std::decay_t<F>&>::value>>
+		CustomLayoutNode(F&& func, const char* label) : CustomLayoutNode(PaneCallable(std::forward<F>(func)), label) {}
 		~CustomLayoutNode();
 
 		void AddVerticalChild(CustomLayoutNode* child);
 		void AddHorizontalChild(CustomLayoutNode* child);
-		void SetHorizontalChildren(CustomLayoutNode* left, CustomLayoutNode* middle = nullptr, CustomLayoutNode* right = nullptr);
-		void SetVerticalChildren(CustomLayoutNode* left, CustomLayoutNode* middle = nullptr, CustomLayoutNode* right = nullptr);
+		// Replace all children at once; any number of children is accepted and
+		// null entries are skipped. Current children not in the list are deleted.
+		void SetHorizontalChildren(std::initializer_list<CustomLayoutNode*> children);
+		void SetVerticalChildren(std::initializer_list<CustomLayoutNode*> children);
+		void SetHorizontalChildren(CustomLayoutNode* const* children, int count);
+		void SetVerticalChildren(CustomLayoutNode* const* children, int count);
+
+		// Tree edits. A detached node is owned by the caller. Moving keeps the
+		// node's pane state; the old and new parent are re-equalised like on any
+		// visible-count change. An edit in code relays out the whole tree on the
+		// next frame; a pane dropped in the UI only relays out both parents.
+		CustomLayoutNode* DetachChild(int childIndex);
+		void InsertChild(int index, CustomLayoutNode* child);
+		// Index is clamped; returns false if newParent is a window node or lies
+		// inside this node's subtree.
+		bool MoveTo(CustomLayoutNode* newParent, int index);
+		int IndexOfChild(const CustomLayoutNode* child) const;
+		bool IsAncestorOf(const CustomLayoutNode* node) const;
+
+		// Tab containers. Inactive tabs are never visited by layout, hit-testing,
+		// rendering or visibility checks, and keep their last geometry, so
+		// switching back to a tab whose rect is unchanged relays out nothing
+		// below it. A hidden active tab falls back to the first visible one.
+		void AddTab(CustomLayoutNode* child);
+		void SetActiveTab(int childIndex);
+		int GetActiveTab() const;
+
+		// Grid nodes. All cells of a column share its width and all cells of a
+		// row its height, so the tracks are sized in one O(columns + rows) pass
+		// and every cell just reads its edges. Dragging a track boundary moves it
+		// for the whole grid. Hidden cells leave their area empty; cells must not
+		// overlap. Resizing the grid keeps the existing track weights.
+		void SetGridSize(int columns, int rows);
+		void AddGridCell(CustomLayoutNode* child, int col, int row, int colSpan = 1, int rowSpan = 1);
+		void SetColumnTrack(int col, float weight, float minSize = 0.f);
+		void SetRowTrack(int row, float weight, float minSize = 0.f);
+		int GetGridColumns() const;
+		int GetGridRows() const;
+		const GridTrack& GetColumnTrack(int col) const;
+		const GridTrack& GetRowTrack(int row) const;
+		// The cell this node occupies in its parent grid.
+		const GridCell& GetGridCell() const;
+
+		// Scroll containers. Each child is as tall as its fixed size, or as the
+		// item extent clamped to its min/max constraints. Only the children that
+		// intersect the view are laid out, hit-tested and rendered; the others
+		// keep their state and last geometry and cost nothing per frame. Children
+		// cut by the edge of the view keep their full extent and are clipped to it.
+		void AddScrollChild(CustomLayoutNode* child);
+		void SetScrollItemExtent(float extent);
+		void SetScrollPos(float pos);
+		float GetScrollPos() const;
+		float GetScrollContentExtent() const;
+		// Children on screen after the last layout pass; empty while a
+		// visibility change is pending.
+		ChildIndexSpan GetOnScreenChildren() const;
 
 		const std::string& GetLabel() const;
 		void SetLabel(const char* label);
 
+		CustomLayoutNode* GetParent() const;
+		// Bumped on this node and every ancestor when children or labels change
+		// anywhere below, so views over the tree know when to rebuild.
+		unsigned int GetStructureVersion() const;
+
 		void SetVisible(bool v);
 		bool IsVisibleFlag() const;
 		bool IsEffectivelyVisible() const;
 		void SetDFSVisible(bool new_status);
 
 		void ResizeNodeAndChildren(ImVec2 newPos, ImVec2 newSize);
+		// Relays out this subtree in its current rect after a change that stays
+		// inside it (a boundary drag, an edit of its children that leaves its
+		// effective visibility alone); the ancestors must have been clean before.
+		void RelayoutSubtree();
+		// After an edit of this node's children, the nearest node at or above it
+		// whose effective visibility is what the last layout pass saw, so its
+		// rect is unchanged. Call before anything refreshes the visibility.
+		CustomLayoutNode* FindEditRelayoutRoot();
+		// Laid out by the last layout pass: visible, and neither in an inactive
+		// tab nor scrolled out of view.
+		bool IsLaidOut() const;
+		void RenderPanes(bool profileCosts = false);
+		// Jobs are numbered from base; the subtree's range is kept for patching.
+		void CollectPrepareJobs(std::vector<PanePrepareJob>& out, int base = 0);
+		int GetPrepareJobBegin() const;
+		int GetPrepareJobEnd() const;
 		void RenderNodeAndChildren();
 		bool FindHoveredSplitter(const ImVec2& mousePos, CustomLayoutNode*& outNode, int& outBoundaryIndex);
+		// Visible window node whose rect contains pos, from the last layout pass.
+		CustomLayoutNode* FindPaneAt(const ImVec2& pos);
+		// Intersection of the views of the scroll containers above this node, the
+		// only area where it is drawn and hit-tested; false if there are none.
+		bool AncestorScrollClip(ImRect& out) const;
 		bool HandleSplitterDragAt(int boundaryIndex, const ImVec2& mouseDelta);
+		void CollectSplitters(SplitterIndex& index) const;
+		bool IsGeometryDirty() const;
 
 		int VisibleChildCount() const;
+		LayoutNodeKind GetKind() const;
+		bool IsTabContainer() const;
+		bool IsGrid() const;
+		bool IsScrollContainer() const;
 		bool IsWindowNode() const;
 		bool IsVerticalSplitter() const;
 		bool IsHorizontalSplitter() const;
+		// True if the boundary is a horizontal line dragged along y (vertical
+		// splitters, grid row boundaries).
+		bool IsVerticalBoundary(int boundaryIndex) const;
 
 		const std::vector<CustomLayoutNode*>& GetChildren() const;
 		std::vector<CustomLayoutNode*>& GetChildren();
 
+		const PaneCallable& GetWindowFunc() const;
+		PaneCallable& GetWindowFunc();
+		float GetSplitRatio(int childIndex) const;
+		// Weight of a flexible child relative to its visible siblings.
+		void SetSplitRatio(int childIndex, float weight);
+
+		void SetSizeConstraints(float minSize, float maxSize = FLT_MAX);
+		void SetFixedSize(float size);   // 0 makes the node flexible again
+		const LayoutConstraints& GetConstraints() const;
+
+		void SetRefreshPolicy(PaneRefreshPolicy policy, float rateHz = 0.f);
+		void InvalidatePane();
+		// Frees pane caches and cost samples in this subtree; geometry is kept.
+		void ReleaseTransientBuffers();
+		// Releases the transient memory of panes in this subtree that were last
+		// submitted before cutoff (ImGui time) and accumulates into stats.
+		void CompactHiddenPanes(double cutoff, LayoutMemoryStats& stats);
+		size_t GetTransientMemoryBytes() const;
+		const PaneRefreshCache& GetPaneCache() const;
+		const PaneCostHistory& GetCostHistory() const;
+
 		void EqualizeIfVisibleCountChanged();
 		ImVec2 GetDomainPos() const;
 		ImVec2 GetDomainSize() const;
 
 	private:
-		bool m_isVertical = false;
+		friend class LayoutSnapshot;
+		friend class FlatLayoutTree;
+
+		LayoutNodeKind m_kind = LayoutNode_Split;
+		bool m_isVertical = false;          // tab containers stack their tab bar over the content
 		std::string m_label;
 		bool m_visible = true;
 		ImVec2 m_domainPos{ 0,0 };
@@ -113,29 +623,276 @@ struct RollingBuffer {
 		std::vector<CustomLayoutNode*> m_children;
 		std::vector<float> m_splitRatios;
 		float m_splitterWidth = 4.0f;
-		float m_minRatio = 0.05f;
+		LayoutConstraints m_constraints;
 		size_t m_lastVisibleCount = 0;
 		bool m_equalizeOnVisibleChange = true;
-		CustomWindowFunc m_pfnCustomWindowFunc = nullptr;
+		PaneCallable m_paneFunc;
+		PaneRefreshCache m_paneCache;
+		PaneCostHistory m_costs;
+		double m_lastSubmitTime = 0.0;      // ImGui time of the last RenderPanes submit
+		bool m_paneCompacted = false;       // released since that submit
 
-		static inline float Clamp01(float v);
+		// cached per-node state, rebuilt only when the dirty flags are raised
+		CustomLayoutNode* m_parent = nullptr;
+		std::vector<int> m_visibleChildren;   // indices into m_children
+		std::vector<float> m_visibleOffsets;  // prefix offsets of the visible children: 0..1 for splits, pixels for scroll containers
+		std::vector<float> m_edges;           // pixel positions of the visible children's edges, n + 1
+		std::vector<float> m_solverScratch;   // suffix sums used by SplitMath::SolveEdges
+		float m_visibleRatioSum = 0.f;
+		bool m_hasConstrainedChild = false;
+		bool m_effectiveVisible = true;
+		bool m_visibilityDirty = true;
+		bool m_ratiosDirty = true;
+		bool m_geometryDirty = true;          // raised on this node and every ancestor
+		unsigned int m_structureVersion = 0;
+		CustomLayoutNode* m_activeTab = nullptr;
+		bool m_tabSelectPending = true;       // push m_activeTab to the ImGui tab bar
+		float m_tabBarHeight = 0.f;
+		struct GridState;
+		GridState* m_grid = nullptr;          // grid nodes only
+		GridCell m_gridCell;                  // placement inside a grid parent
+		float m_scrollPos = 0.f;
+		float m_scrollItemExtent = 200.f;
+		float m_scrollBarWidth = 0.f;
+		int m_scrollFirst = 0;                // on-screen slice of m_visibleChildren
+		int m_scrollLast = 0;
+		int m_prepareJobBegin = 0;            // subtree's jobs in the last CollectPrepareJobs
+		int m_prepareJobEnd = 0;
+
+		void AttachChild(CustomLayoutNode* child);
+		void MarkVisibilityDirty();
+		void MarkGeometryDirty();
+		void MarkStructureChanged();
+		void RefreshVisibility();
+		void SetChildren(CustomLayoutNode* const* children, int count);
+		void RefreshOffsets();
+		void MarkConstraintsDirty();
+		float BoundaryPos(int boundaryIndex) const;
+		bool ComputeEffectiveVisibility() const;
+		CustomLayoutNode* ResolveActiveTab() const;
+		void DrawTabBar(const ImRect* clip);
+		void RefreshGridCells();
+		void ResizeGrid();
+		bool HandleGridDragAt(int boundaryIndex, const ImVec2& mouseDelta);
+		CustomLayoutNode* GridChildAt(const ImVec2& pos) const;
+		void RefreshScrollOffsets();
+		void ResizeScroll();
+		void DrawScrollBar(const ImRect* clip);
+		ChildIndexSpan LaidOutChildren() const;
+		// Scroll views clip everything below them; clip is their intersection, or
+		// nullptr outside any scroll container.
+		ImRect ScrollViewRect() const;
+		void RenderPanesClipped(bool profileCosts, const ImRect* clip);
+		void RenderNodeClipped(const ImRect* clip);
+		void CollectSplittersClipped(SplitterIndex& index, const ImRect* clip) const;
+	};
+
+	class FlatLayoutTree;
+	class PaneWorkerPool;
+	class LayoutTreeView;
+
+	// One splitter boundary as a line segment. Vertical splitters produce
+	// horizontal lines at y = pos spanning x in [spanMin, spanMax], horizontal
+	// splitters vertical lines at x = pos spanning y.
+	struct SplitterSegment {
+		float pos;
+		float spanMin;
+		float spanMax;
+		int order;                  // DFS order, parents before children
+		int boundaryIndex;
+		CustomLayoutNode* node;     // set when collected from a CustomLayoutNode tree
+		int flatNode;               // set when collected from a FlatLayoutTree
+	};
+
+	// Splitter segments bucketed by axis and sorted by position, so hover
+	// lookups are a binary search instead of a walk over the whole tree.
+	// Rebuilt by CustomLayout only when the layout geometry changes.
+	class SplitterIndex {
+	public:
+		void Clear();
+		void Add(bool verticalSplit, float pos, float spanMin, float spanMax, int boundaryIndex, CustomLayoutNode* node, int flatNode = -1);
+		void Build();
+		const SplitterSegment* Find(const ImVec2& mousePos, float pad) const;
+		int Size() const;
+
+		// Moves the segments of one relaid-out subtree in place. `subtree` holds
+		// its segments as collected now (not built), `area` bounds the old and
+		// the new ones and inSubtree(segment) picks out the old ones. Returns
+		// false, changing nothing, when they no longer pair up in DFS order; the
+		// index must then be rebuilt.
+		template <typename InSubtree>
+		bool Patch(const SplitterIndex& subtree, const ImRect& area, InSubtree&& inSubtree) {
+			for (int axis = 0; axis < 2; ++axis) {
+				std::vector<SplitterSegment>& bucket = axis ? m_verticalLines : m_horizontalLines;
+				const int first = LowerBound(bucket, (axis ? area.Min.x : area.Min.y) - 1.f);
+				const int last = LowerBound(bucket, (axis ? area.Max.x : area.Max.y) + 1.f);
+				m_patchOld[axis].clear();
+				for (int i = first; i < last; ++i) if (inSubtree(bucket[i])) m_patchOld[axis].push_back(i);
+				m_patchRange[axis][0] = first;
+				m_patchRange[axis][1] = last;
+			}
+			return ApplyPatch(subtree);
+		}
+
+		// Replaces the segments of one subtree whose children changed, so their
+		// number may differ. `subtree` holds its segments as collected now,
+		// `area` bounds the old ones, inSubtree(segment) picks them out and
+		// before(segment) tells whether a segment is collected ahead of the
+		// subtree, which places the new ones when there were no old ones. The
+		// new segments take the DFS orders of the old run and every later
+		// segment is renumbered. Returns false, changing nothing, when the old
+		// segments are not one run; the index must then be rebuilt.
+		template <typename InSubtree, typename Before>
+		bool Replace(const SplitterIndex& subtree, const ImRect& area, InSubtree&& inSubtree, Before&& before) {
+			int first = INT_MAX, last = -1, count = 0;
+			for (int axis = 0; axis < 2; ++axis) {
+				std::vector<SplitterSegment>& bucket = axis ? m_verticalLines : m_horizontalLines;
+				const int lo = LowerBound(bucket, (axis ? area.Min.x : area.Min.y) - 1.f);
+				const int hi = LowerBound(bucket, (axis ? area.Max.x : area.Max.y) + 1.f);
+				m_patchOld[axis].clear();
+				for (int i = lo; i < hi; ++i) {
+					if (!inSubtree(bucket[i])) continue;
+					m_patchOld[axis].push_back(i);
+					first = ImMin(first, bucket[i].order);
+					last = ImMax(last, bucket[i].order);
+					++count;
+				}
+			}
+			if (count == 0) {
+				first = 0;
+				for (const std::vector<SplitterSegment>* bucket : { &m_horizontalLines, &m_verticalLines })
+					for (const SplitterSegment& seg : *bucket) if (before(seg)) first = ImMax(first, seg.order + 1);
+			}
+			else if (last - first + 1 != count) return false;
+			ApplyReplace(subtree, first, count);
+			return true;
+		}
+
+	private:
+		static const SplitterSegment* FindInBucket(const std::vector<SplitterSegment>& bucket, float along, float across, float pad, const SplitterSegment* best);
+		static int LowerBound(const std::vector<SplitterSegment>& bucket, float pos);
+		bool ApplyPatch(const SplitterIndex& subtree);
+		void ApplyReplace(const SplitterIndex& subtree, int first, int count);
+
+		std::vector<SplitterSegment> m_horizontalLines; // from vertical splitters, keyed by y
+		std::vector<SplitterSegment> m_verticalLines;   // from horizontal splitters, keyed by x
+		std::vector<int> m_patchOld[2];                 // Patch scratch, per bucket
+		int m_patchRange[2][2] = {};
 	};
 
+	// Drives either the pointer-based CustomLayoutNode tree or a FlatLayoutTree.
+	// The layout takes ownership of whichever tree it is given.
 	class CustomLayout {
 	public:
 		explicit CustomLayout(CustomLayoutNode* root);
+		explicit CustomLayout(FlatLayoutTree* tree);
 		~CustomLayout();
 
 		void UpdateAndRender();
 		CustomLayoutNode* GetRoot();
+		FlatLayoutTree* GetFlatTree();
+
+		int GetRelayoutCount() const;
+		float GetRelayoutsPerSecond() const;
+
+		// Persists the node tree's ratios and visibility in imgui.ini under the
+		// given name. Call before the first ImGui::NewFrame().
+		void EnableIniSettings(const char* name);
+
+		// Times every pane callback and records its draw counts; the Layout
+		// Control panel then lists panes by cost. Panes over either budget are
+		// highlighted.
+		void EnablePaneProfiling(bool enable);
+		bool IsPaneProfilingEnabled() const;
+		void SetPaneBudget(float cpuUs, int vertices);
+
+		// Runs the Prepare phase of two-phase panes (see HasPanePrepare) on a
+		// worker pool before the panes are submitted. workerCount 0 uses one
+		// worker per hardware thread besides the UI thread, which joins in.
+		// Disabled, Prepare runs on the UI thread.
+		void EnableParallelPrepare(bool enable, int workerCount = 0);
+		bool IsParallelPrepareEnabled() const;
+
+		// Frees buffers that only speed up the next frames (pane draw caches, cost
+		// samples, table rows). Cached geometry and pane state are kept, so the
+		// next UpdateAndRender does not relayout.
+		void ReleaseTransientBuffers();
+
+		// Seconds a pane must stay hidden (unchecked, in an inactive tab or
+		// scrolled out of view) before its draw buffers, cost samples
+		// and Compact() hook memory are released; negative disables it. Hidden
+		// panes are swept once per second.
+		void SetHiddenCompactDelay(float seconds);
+		float GetHiddenCompactDelay() const;
+		const LayoutMemoryStats& GetMemoryStats() const;
+
+		// Called inside the Layout Control panel, after the layout's own
+		// controls, to add controls that belong to the application (e.g. a
+		// workspace selector). Null removes it.
+		void SetControlPanelCallback(void (*callback)(void* userData), void* userData = nullptr);
 
 	private:
+		struct PaneCostRow {
+			const CustomLayoutNode* node;
+			PaneCostSummary summary;
+			int lastVertices;
+			bool overBudget;
+		};
+		void UpdateAndRenderFlat();
+		void RebuildSplitterIndex();
+		void RebuildLayoutCaches();
+		bool PatchDraggedSubtree();
+		void MovePane(CustomLayoutNode* node, CustomLayoutNode* parent, int index);
+		bool PatchMovedSubtrees(const CustomLayoutNode* moved, CustomLayoutNode* a, CustomLayoutNode* b);
+		void UpdatePaneDragSource();
+		bool ViewportChanged(const ImGuiViewport* vp) const;
+		void CountRelayout();
+		void UpdateRelayoutRate();
+		void BeginControlPanel();
+		void EndControlPanel();
 		void DrawControlPanel();
+		void DrawFlatControlPanel();
+		void DrawPaneCostTable();
+		void DrawMemoryStats();
+		void CollectPaneCostRows(const CustomLayoutNode* node);
+		void PreparePanes();
+		void CompactHiddenPanes();
+		bool HandlePaneDrop();
+		bool FindPaneDropTarget(const ImVec2& mouse, const CustomLayoutNode* dragged, CustomLayoutNode*& outParent, int& outIndex, ImRect& outPreview);
 
 		CustomLayoutNode* m_root = nullptr;
+		FlatLayoutTree* m_flat = nullptr;
+		SplitterIndex m_splitterIndex;
+		ImVec2 m_lastViewportPos{ 0,0 };
 		ImVec2 m_lastViewportSize{ 0,0 };
 		CustomLayoutNode* m_activeNode = nullptr;
+		int m_activeFlatNode = -1;
 		int m_activeBoundaryIndex = -1;
+
+		int m_relayoutCount = 0;
+		int m_relayoutsInWindow = 0;
+		float m_relayoutWindowTime = 0.f;
+		float m_relayoutsPerSecond = 0.f;
+		bool m_iniSettings = false;
+
+		bool m_profilePanes = false;
+		float m_budgetCpuUs = 1000.f;
+		int m_budgetVertices = 20000;
+		std::vector<PaneCostRow> m_paneCostRows;
+
+		float m_hiddenCompactDelay = 60.f;
+		float m_compactSweepTime = 0.f;
+		LayoutMemoryStats m_memoryStats;
+
+		LayoutTreeView* m_treeView = nullptr;
+		ImGuiWindow* m_panelWindow = nullptr;
+		void (*m_panelCallback)(void* userData) = nullptr;
+		void* m_panelCallbackData = nullptr;
+		PaneWorkerPool* m_prepareWorkers = nullptr;
+		std::vector<PanePrepareJob> m_prepareJobs;   // rebuilt on relayout, patched on drags
+		SplitterIndex m_subtreeSplitters;             // scratch of PatchDraggedSubtree and PatchMovedSubtrees
+		std::vector<PanePrepareJob> m_subtreeJobs;
+		CustomLayoutNode* m_titleDragPane = nullptr;  // pane picked up by its title bar
 	};
 
 } // namespace FrameGUILayout
\ No newline at end of file
@@ -0,0 +1,403 @@
+#include "FrameGUILayoutSnapshot.h"
+#include <cstddef>
+#include <cstring>
+#include <deque>
+
+namespace FrameGUILayout {
+
+	static_assert(sizeof(float) == 4, "Snapshot records store 32-bit floats");
+
+	LayoutSnapshot::NodeKind LayoutSnapshot::KindOf(const CustomLayoutNode* node) {
+		if (node->IsWindowNode()) return NodeKind_Window;
+		if (node->IsTabContainer()) return NodeKind_Tabs;
+		if (node->IsGrid()) return NodeKind_Grid;
+		if (node->IsScrollContainer()) return NodeKind_Scroll;
+		return node->m_isVertical ? NodeKind_Vertical : NodeKind_Horizontal;
+	}
+
+	static uint32_t GridBytes(const CustomLayoutNode* node, uint32_t childCount) {
+		return (uint32_t)(sizeof(uint16_t) * 2 + sizeof(GridTrack) * (node->GetGridColumns() + node->GetGridRows()) + sizeof(uint16_t) * 4 * childCount);
+	}
+
+	void LayoutSnapshot::CountNodes(const CustomLayoutNode* node, uint32_t& nodes, uint32_t& stringBytes, uint32_t& gridBytes) {
+		++nodes;
+		stringBytes += (uint32_t)node->m_label.size();
+		uint32_t children = 0;
+		for (const CustomLayoutNode* c : node->m_children) if (c) { CountNodes(c, nodes, stringBytes, gridBytes); ++children; }
+		if (node->IsGrid()) gridBytes += GridBytes(node, children);
+	}
+
+	static void WriteU16(unsigned char*& out, int v) {
+		const uint16_t u = (uint16_t)v;
+		memcpy(out, &u, sizeof(u));
+		out += sizeof(u);
+	}
+
+	void LayoutSnapshot::WriteNode(const CustomLayoutNode* node, float ratio, Writer& w) {
+		NodeRecord r;
+		r.kind = KindOf(node);
+		r.flags = (node->m_visible ? RecordFlags_Visible : 0) | (node->m_equalizeOnVisibleChange ? RecordFlags_Equalize : 0);
+		if (node->m_parent && node->m_parent->IsTabContainer() && node->m_parent->m_activeTab == node) r.flags |= RecordFlags_ActiveTab;
+		r.labelLength = (uint16_t)node->m_label.size();
+		r.childCount = 0;
+		for (const CustomLayoutNode* c : node->m_children) if (c) ++r.childCount;
+		r.labelOffset = w.stringOffset;
+		r.ratio = ratio;
+		r.minSize = node->m_constraints.MinSize;
+		r.maxSize = node->m_constraints.MaxSize;
+		r.fixedSize = node->m_constraints.FixedSize;
+		memcpy(w.records++, &r, sizeof(r));
+		memcpy(w.strings + w.stringOffset, node->m_label.data(), r.labelLength);
+		w.stringOffset += r.labelLength;
+
+		if (node->IsGrid()) {
+			WriteU16(w.grid, node->GetGridColumns());
+			WriteU16(w.grid, node->GetGridRows());
+			for (int i = 0; i < node->GetGridColumns(); ++i) { memcpy(w.grid, &node->GetColumnTrack(i), sizeof(GridTrack)); w.grid += sizeof(GridTrack); }
+			for (int i = 0; i < node->GetGridRows(); ++i) { memcpy(w.grid, &node->GetRowTrack(i), sizeof(GridTrack)); w.grid += sizeof(GridTrack); }
+			for (const CustomLayoutNode* c : node->m_children) {
+				if (!c) continue;
+				WriteU16(w.grid, c->m_gridCell.Col);
+				WriteU16(w.grid, c->m_gridCell.Row);
+				WriteU16(w.grid, c->m_gridCell.ColSpan);
+				WriteU16(w.grid, c->m_gridCell.RowSpan);
+			}
+		}
+
+		for (size_t i = 0; i < node->m_children.size(); ++i)
+			if (node->m_children[i]) WriteNode(node->m_children[i], node->m_splitRatios[i], w);
+	}
+
+	void LayoutSnapshot::Save(const CustomLayoutNode* root, ImVector<unsigned char>& out) {
+		assert(root != nullptr && "Root must not be null");
+		uint32_t nodes = 0, stringBytes = 0, gridBytes = 0;
+		CountNodes(root, nodes, stringBytes, gridBytes);
+
+		Header h;
+		h.magic = Magic;
+		h.version = Version;
+		h.headerSize = (uint16_t)sizeof(Header);
+		h.nodeCount = nodes;
+		h.stringBytes = stringBytes;
+		h.gridBytes = gridBytes;
+
+		out.resize((int)(sizeof(Header) + nodes * sizeof(NodeRecord) + stringBytes + gridBytes));
+		memcpy(out.Data, &h, sizeof(h));
+		Writer w;
+		w.records = (NodeRecord*)(out.Data + sizeof(Header));
+		w.strings = (char*)(out.Data + sizeof(Header) + nodes * sizeof(NodeRecord));
+		w.grid = out.Data + sizeof(Header) + nodes * sizeof(NodeRecord) + stringBytes;
+		w.stringOffset = 0;
+		WriteNode(root, 1.f, w);
+	}
+
+	bool LayoutSnapshot::Parse(const void* data, size_t size, View& out) {
+		if (!data || size < sizeof(Header)) return false;
+		Header h;
+		memcpy(&h, data, sizeof(Header));
+		if (h.magic != Magic || h.version != Version || h.headerSize < sizeof(Header)) return false;
+		if (h.nodeCount == 0) return false;
+		const size_t expected = (size_t)h.headerSize + (size_t)h.nodeCount * sizeof(NodeRecord) + h.stringBytes + h.gridBytes;
+		if (size < expected) return false;
+
+		out.records = (const NodeRecord*)((const char*)data + h.headerSize);
+		out.strings = (const char*)out.records + (size_t)h.nodeCount * sizeof(NodeRecord);
+		out.grid = (const unsigned char*)out.strings + h.stringBytes;
+		out.nodeCount = h.nodeCount;
+		out.stringBytes = h.stringBytes;
+		out.gridBytes = h.gridBytes;
+		return true;
+	}
+
+	static int ReadU16(const unsigned char* p, int index) {
+		uint16_t u;
+		memcpy(&u, p + index * sizeof(u), sizeof(u));
+		return u;
+	}
+
+	// Grid entries follow the preorder of the grid nodes. Returns false if the
+	// entry does not fit in the table.
+	bool LayoutSnapshot::ReadGrid(const View& view, Cursor& cursor, uint32_t childCount, GridEntry& out) {
+		if ((uint64_t)cursor.grid + sizeof(uint16_t) * 2 > view.gridBytes) return false;
+		const unsigned char* p = view.grid + cursor.grid;
+		out.columns = ReadU16(p, 0);
+		out.rows = ReadU16(p, 1);
+		if (out.columns == 0 || out.rows == 0) return false;
+		const uint64_t bytes = sizeof(uint16_t) * 2 + sizeof(GridTrack) * (uint64_t)(out.columns + out.rows) + sizeof(uint16_t) * 4 * (uint64_t)childCount;
+		if (cursor.grid + bytes > view.gridBytes) return false;
+		out.tracks = p + sizeof(uint16_t) * 2;
+		out.cells = out.tracks + sizeof(GridTrack) * (out.columns + out.rows);
+		cursor.grid += (uint32_t)bytes;
+		return true;
+	}
+
+	GridTrack LayoutSnapshot::GridEntry::Track(int i) const {
+		GridTrack t;
+		memcpy(&t, tracks + i * sizeof(GridTrack), sizeof(t));
+		return t;
+	}
+
+	GridCell LayoutSnapshot::GridEntry::Cell(int i) const {
+		GridCell c;
+		c.Col = ReadU16(cells, i * 4 + 0);
+		c.Row = ReadU16(cells, i * 4 + 1);
+		c.ColSpan = ReadU16(cells, i * 4 + 2);
+		c.RowSpan = ReadU16(cells, i * 4 + 3);
+		return c;
+	}
+
+	void LayoutSnapshot::ApplyGridTracks(CustomLayoutNode* node, const GridEntry& grid) {
+		for (int i = 0; i < grid.columns; ++i) { const GridTrack t = grid.Track(i); node->SetColumnTrack(i, t.Weight, t.MinSize); }
+		for (int i = 0; i < grid.rows; ++i) { const GridTrack t = grid.Track(grid.columns + i); node->SetRowTrack(i, t.Weight, t.MinSize); }
+	}
+
+	bool LayoutSnapshot::Matches(const CustomLayoutNode* node, const View& view, Cursor& cursor) {
+		if (cursor.node >= view.nodeCount) return false;
+		const NodeRecord& r = view.records[cursor.node++];
+		if (r.kind != KindOf(node)) return false;
+		if ((uint64_t)r.labelOffset + r.labelLength > view.stringBytes) return false;
+		if (node->IsGrid()) {
+			GridEntry grid;
+			if (!ReadGrid(view, cursor, r.childCount, grid)) return false;
+			if (grid.columns != node->GetGridColumns() || grid.rows != node->GetGridRows()) return false;
+		}
+
+		uint32_t children = 0;
+		for (const CustomLayoutNode* c : node->m_children) {
+			if (!c) continue;
+			if (!Matches(c, view, cursor)) return false;
+			++children;
+		}
+		return children == r.childCount;
+	}
+
+	void LayoutSnapshot::ApplyNode(CustomLayoutNode* node, const View& view, Cursor& cursor) {
+		const NodeRecord& r = view.records[cursor.node++];
+		// the label is not null-terminated, so SetLabel cannot take it directly;
+		// views over the tree rebuild on the structure version
+		if (node->m_label.size() != r.labelLength || memcmp(node->m_label.data(), view.strings + r.labelOffset, r.labelLength) != 0) {
+			node->m_label.assign(view.strings + r.labelOffset, r.labelLength);
+			node->MarkStructureChanged();
+		}
+		node->m_visible = (r.flags & RecordFlags_Visible) != 0;
+		node->m_equalizeOnVisibleChange = (r.flags & RecordFlags_Equalize) != 0;
+		node->m_constraints.MinSize = r.minSize;
+		node->m_constraints.MaxSize = r.maxSize;
+		node->m_constraints.FixedSize = r.fixedSize;
+
+		// Matches checked the dimensions; the cells are kept as built in code
+		GridEntry grid;
+		if (node->IsGrid() && ReadGrid(view, cursor, r.childCount, grid)) {
+			ApplyGridTracks(node, grid);
+		}
+
+		for (size_t i = 0; i < node->m_children.size(); ++i) {
+			CustomLayoutNode* c = node->m_children[i];
+			if (!c) continue;
+			node->m_splitRatios[i] = view.records[cursor.node].ratio;
+			if (node->IsTabContainer() && (view.records[cursor.node].flags & RecordFlags_ActiveTab)) {
+				node->m_activeTab = c;
+				node->m_tabSelectPending = true;
+			}
+			ApplyNode(c, view, cursor);
+		}
+
+		// children are already refreshed, so this only rebuilds this level; the
+		// visible count is recorded so the first frame does not re-equalise
+		node->m_visibilityDirty = true;
+		node->RefreshVisibility();
+		node->m_lastVisibleCount = node->m_visibleChildren.size();
+		node->m_ratiosDirty = true;
+		node->m_geometryDirty = true;
+	}
+
+	bool LayoutSnapshot::Apply(CustomLayoutNode* root, const void* data, size_t size) {
+		View view;
+		if (!root || !Parse(data, size, view)) return false;
+		Cursor cursor;
+		if (!Matches(root, view, cursor) || cursor.node != view.nodeCount) return false;
+
+		cursor = Cursor();
+		ApplyNode(root, view, cursor);
+		root->MarkVisibilityDirty();
+		return true;
+	}
+
+	CustomLayoutNode* LayoutSnapshot::BuildNode(const View& view, Cursor& cursor, PaneResolver resolver) {
+		if (cursor.node >= view.nodeCount) return nullptr;
+		const NodeRecord& r = view.records[cursor.node++];
+		if ((uint64_t)r.labelOffset + r.labelLength > view.stringBytes) return nullptr;
+
+		char label[256];
+		ImStrncpy(label, view.strings + r.labelOffset, ImMin((int)r.labelLength + 1, (int)IM_ARRAYSIZE(label)));
+
+		GridEntry grid;
+		CustomLayoutNode* node = nullptr;
+		if (r.kind == NodeKind_Window) {
+			if (r.childCount != 0) return nullptr;
+			PaneCallable func = resolver ? resolver(label) : PaneCallable();
+			if (!func) return nullptr;
+			node = new CustomLayoutNode(std::move(func), label);
+		}
+		else if (r.kind == NodeKind_Tabs || r.kind == NodeKind_Scroll) {
+			node = new CustomLayoutNode(r.kind == NodeKind_Tabs ? LayoutNode_Tabs : LayoutNode_Scroll, label);
+		}
+		else if (r.kind == NodeKind_Grid) {
+			if (!ReadGrid(view, cursor, r.childCount, grid)) return nullptr;
+			node = new CustomLayoutNode(LayoutNode_Grid, label);
+			node->SetGridSize(grid.columns, grid.rows);
+			ApplyGridTracks(node, grid);
+		}
+		else {
+			node = new CustomLayoutNode(r.kind == NodeKind_Vertical, label);
+		}
+		node->m_label.assign(view.strings + r.labelOffset, r.labelLength);
+		node->m_visible = (r.flags & RecordFlags_Visible) != 0;
+		node->m_equalizeOnVisibleChange = (r.flags & RecordFlags_Equalize) != 0;
+		node->m_constraints.MinSize = r.minSize;
+		node->m_constraints.MaxSize = r.maxSize;
+		node->m_constraints.FixedSize = r.fixedSize;
+
+		node->m_children.reserve(r.childCount);
+		for (uint32_t i = 0; i < r.childCount; ++i) {
+			const float ratio = cursor.node < view.nodeCount ? view.records[cursor.node].ratio : 0.f;
+			const bool activeTab = cursor.node < view.nodeCount && (view.records[cursor.node].flags & RecordFlags_ActiveTab) != 0;
+			CustomLayoutNode* child = BuildNode(view, cursor, resolver);
+			if (!child) { delete node; return nullptr; }
+			// cells are clipped to the grid at layout time, so a corrupt entry
+			// cannot index outside it
+			if (node->IsGrid()) child->m_gridCell = grid.Cell((int)i);
+			node->AttachChild(child);
+			node->m_splitRatios.back() = ratio;
+			if (activeTab && node->IsTabContainer()) node->m_activeTab = child;
+		}
+
+		node->RefreshVisibility();
+		node->m_lastVisibleCount = node->m_visibleChildren.size();
+		return node;
+	}
+
+	CustomLayoutNode* LayoutSnapshot::Build(const void* data, size_t size, PaneResolver resolver) {
+		View view;
+		if (!Parse(data, size, view)) return nullptr;
+		Cursor cursor;
+		CustomLayoutNode* root = BuildNode(view, cursor, resolver);
+		if (root && cursor.node != view.nodeCount) { delete root; return nullptr; }
+		return root;
+	}
+
+	// imgui.ini integration. One handler serves every registered layout; each
+	// layout is stored as a hex encoded snapshot under its own entry name.
+	// Entries outlive their layout (and entries read for layouts that were never
+	// registered are kept) so the ini does not lose them on the next save.
+	struct IniLayoutEntry {
+		CustomLayout* layout;
+		std::string name;
+		ImVector<unsigned char> data; // pending snapshot, or the last one of a detached layout
+	};
+
+	// a deque, so the entry pointers handed to ImGui between ReadOpen and
+	// ReadLine stay valid while later entries are added
+	static std::deque<IniLayoutEntry> s_iniLayouts;
+	static const char* const s_iniTypeName = "FrameGUILayout";
+
+	static IniLayoutEntry* FindIniEntry(const char* name) {
+		for (IniLayoutEntry& e : s_iniLayouts)
+			if (e.name == name) return &e;
+		return nullptr;
+	}
+
+	static int HexDigit(char c) {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	static void* IniReadOpen(ImGuiContext*, ImGuiSettingsHandler*, const char* name) {
+		if (IniLayoutEntry* e = FindIniEntry(name)) return e;
+		s_iniLayouts.push_back(IniLayoutEntry{ nullptr, name, {} });
+		return &s_iniLayouts.back();
+	}
+
+	static void IniReadLine(ImGuiContext*, ImGuiSettingsHandler*, void* entry, const char* line) {
+		const char* prefix = "Snapshot=";
+		if (strncmp(line, prefix, strlen(prefix)) != 0) return;
+		const char* hex = line + strlen(prefix);
+		const size_t len = strlen(hex) / 2;
+
+		IniLayoutEntry& e = *(IniLayoutEntry*)entry;
+		e.data.resize((int)len);
+		for (size_t i = 0; i < len; ++i) {
+			int hi = HexDigit(hex[i * 2]), lo = HexDigit(hex[i * 2 + 1]);
+			if (hi < 0 || lo < 0) { e.data.clear(); return; }
+			e.data[(int)i] = (unsigned char)((hi << 4) | lo);
+		}
+	}
+
+	static void ApplyIniEntry(IniLayoutEntry& e) {
+		if (!e.layout || e.data.empty()) return;
+		if (CustomLayoutNode* root = e.layout->GetRoot())
+			LayoutSnapshot::Apply(root, e.data.Data, (size_t)e.data.Size);
+		e.data.clear();
+	}
+
+	static void IniApplyAll(ImGuiContext*, ImGuiSettingsHandler*) {
+		for (IniLayoutEntry& e : s_iniLayouts) ApplyIniEntry(e);
+	}
+
+	static void IniWriteAll(ImGuiContext*, ImGuiSettingsHandler* handler, ImGuiTextBuffer* buf) {
+		static const char digits[] = "0123456789abcdef";
+		ImVector<unsigned char> blob;
+		for (IniLayoutEntry& e : s_iniLayouts) {
+			const ImVector<unsigned char>* src = &e.data;
+			if (e.layout && e.layout->GetRoot()) {
+				LayoutSnapshot::Save(e.layout->GetRoot(), blob);
+				src = &blob;
+			}
+			if (src->empty()) continue;
+			buf->reserve(buf->size() + src->Size * 2 + (int)e.name.size() + 32);
+			buf->appendf("[%s][%s]\nSnapshot=", handler->TypeName, e.name.c_str());
+			char pair[2];
+			for (unsigned char b : *src) {
+				pair[0] = digits[b >> 4]; pair[1] = digits[b & 15];
+				buf->append(pair, pair + 2);
+			}
+			buf->append("\n\n");
+		}
+	}
+
+	void LayoutSnapshot::RegisterIniSettings(CustomLayout* layout, const char* name) {
+		assert(layout && name && "Layout and name must not be null");
+		UnregisterIniSettings(layout);
+
+		if (!ImGui::FindSettingsHandler(s_iniTypeName)) {
+			ImGuiSettingsHandler handler;
+			handler.TypeName = s_iniTypeName;
+			handler.TypeHash = ImHashStr(s_iniTypeName);
+			handler.ReadOpenFn = IniReadOpen;
+			handler.ReadLineFn = IniReadLine;
+			handler.ApplyAllFn = IniApplyAll;
+			handler.WriteAllFn = IniWriteAll;
+			ImGui::AddSettingsHandler(&handler);
+		}
+
+		IniLayoutEntry* e = FindIniEntry(name);
+		if (!e) {
+			s_iniLayouts.push_back(IniLayoutEntry{ nullptr, name, {} });
+			e = &s_iniLayouts.back();
+		}
+		e->layout = layout;
+		// settings already loaded (registered after the first frame): apply now
+		if (GImGui->SettingsLoaded) ApplyIniEntry(*e);
+	}
+
+	void LayoutSnapshot::UnregisterIniSettings(CustomLayout* layout) {
+		for (IniLayoutEntry& e : s_iniLayouts) {
+			if (e.layout != layout) continue;
+			if (CustomLayoutNode* root = layout->GetRoot()) Save(root, e.data);
+			e.layout = nullptr;
+		}
+	}
+
+} // namespace FrameGUILayout
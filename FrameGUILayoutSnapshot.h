@@ -0,0 +1,108 @@
+#pragma once
+
+#include "FrameGUILayout.h"
+#include <cstdint>
+
+namespace FrameGUILayout {
+
+	// Resolves the window function of a pane from its label when a tree is
+	// rebuilt from a snapshot. Returning an empty callable rejects the snapshot.
+	using PaneResolver = PaneCallable (*)(const char* label);
+
+	// Compact, versioned binary image of a CustomLayoutNode tree: shape, labels,
+	// split ratios, visibility, pixel size constraints, active tabs and grid
+	// tracks. Nodes are stored in preorder as
+	// fixed-size records followed by one string table; values are written in
+	// host (little-endian) byte order.
+	class LayoutSnapshot {
+	public:
+		static constexpr uint32_t Magic = 0x534C4746; // "FGLS"
+		static constexpr uint16_t Version = 1;
+
+		static void Save(const CustomLayoutNode* root, ImVector<unsigned char>& out);
+
+		// Restores ratios, visibility, constraints and labels onto a tree of the
+		// same shape in one pass. The tree is left untouched if the shape differs.
+		static bool Apply(CustomLayoutNode* root, const void* data, size_t size);
+
+		// Builds a new tree from the snapshot, resolving window functions by label.
+		static CustomLayoutNode* Build(const void* data, size_t size, PaneResolver resolver);
+
+		// Round-trips the layout through imgui.ini as a [FrameGUILayout][name]
+		// entry. Must be called before the first ImGui::NewFrame() so the stored
+		// snapshot is applied before the first layout pass.
+		static void RegisterIniSettings(CustomLayout* layout, const char* name);
+		static void UnregisterIniSettings(CustomLayout* layout);
+
+	private:
+		struct Header {
+			uint32_t magic;
+			uint16_t version;
+			uint16_t headerSize;
+			uint32_t nodeCount;
+			uint32_t stringBytes;
+			uint32_t gridBytes;
+		};
+
+		enum NodeKind : uint8_t { NodeKind_Horizontal, NodeKind_Vertical, NodeKind_Window, NodeKind_Tabs, NodeKind_Grid, NodeKind_Scroll };
+		// ActiveTab is set on the active child of a tab container
+		enum RecordFlags : uint8_t { RecordFlags_Visible = 1 << 0, RecordFlags_Equalize = 1 << 1, RecordFlags_ActiveTab = 1 << 2 };
+
+		struct NodeRecord {
+			uint8_t kind;
+			uint8_t flags;
+			uint16_t labelLength;
+			uint32_t childCount;
+			uint32_t labelOffset;
+			float ratio;        // split ratio of the node inside its parent
+			float minSize;
+			float maxSize;
+			float fixedSize;
+		};
+
+		// The grid table follows the strings: per grid node, in preorder, the
+		// column and row counts (uint16), every column then row track and one
+		// cell (four uint16) per child.
+		struct View {
+			const NodeRecord* records;
+			const char* strings;
+			const unsigned char* grid;
+			uint32_t nodeCount;
+			uint32_t stringBytes;
+			uint32_t gridBytes;
+		};
+
+		struct Cursor {
+			uint32_t node = 0;
+			uint32_t grid = 0;      // byte offset into the grid table
+		};
+
+		struct Writer {
+			NodeRecord* records;
+			char* strings;
+			unsigned char* grid;
+			uint32_t stringOffset;
+		};
+
+		struct GridEntry {
+			int columns = 0;
+			int rows = 0;
+			const unsigned char* tracks = nullptr;
+			const unsigned char* cells = nullptr;
+
+			GridTrack Track(int i) const;   // columns first, then rows
+			GridCell Cell(int i) const;
+		};
+
+		static bool Parse(const void* data, size_t size, View& out);
+		static NodeKind KindOf(const CustomLayoutNode* node);
+		static void CountNodes(const CustomLayoutNode* node, uint32_t& nodes, uint32_t& stringBytes, uint32_t& gridBytes);
+		static void WriteNode(const CustomLayoutNode* node, float ratio, Writer& w);
+		static bool ReadGrid(const View& view, Cursor& cursor, uint32_t childCount, GridEntry& out);
+		static void ApplyGridTracks(CustomLayoutNode* node, const GridEntry& grid);
+		static bool Matches(const CustomLayoutNode* node, const View& view, Cursor& cursor);
+		static void ApplyNode(CustomLayoutNode* node, const View& view, Cursor& cursor);
+		static CustomLayoutNode* BuildNode(const View& view, Cursor& cursor, PaneResolver resolver);
+	};
+
+} // namespace FrameGUILayout
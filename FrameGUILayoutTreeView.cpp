@@ -0,0 +1,213 @@
+#include "FrameGUILayoutTreeView.h"
+#include "FrameGUIFlatLayout.h"
+#include <cstring>
+
+namespace FrameGUILayout {
+
+	LayoutTreeView::LayoutTreeView(CustomLayoutNode* root) : m_root(root) {}
+	LayoutTreeView::LayoutTreeView(FlatLayoutTree* tree) : m_flat(tree) {}
+
+	// Flat trees only ever grow, so their node count is their version.
+	unsigned int LayoutTreeView::CurrentVersion() const {
+		return m_root ? m_root->GetStructureVersion() : (unsigned int)m_flat->NodeCount();
+	}
+
+	void LayoutTreeView::Release() {
+		std::vector<Row>().swap(m_rows);
+		std::vector<char>().swap(m_labels);
+		std::vector<int>().swap(m_visibleRows);
+		m_rowsValid = false;
+	}
+
+	void LayoutTreeView::RebuildRows() {
+		m_rows.clear();
+		m_labels.clear();
+		int c = 0;
+		if (m_root) {
+			for (CustomLayoutNode* child : m_root->GetChildren()) if (child) AppendNodeRows(child, -1, 0, c++);
+		}
+		else {
+			for (int n = m_flat->GetFirstChild(0); n >= 0; n = m_flat->GetNextSibling(n)) AppendFlatRows(n, -1, 0, c++);
+		}
+		m_builtVersion = CurrentVersion();
+		m_rowsValid = true;
+		ApplyFilter(false);
+	}
+
+	void LayoutTreeView::AppendNodeRows(CustomLayoutNode* node, int parent, int depth, int childIndex) {
+		const int row = AppendRow(node, -1, parent, depth, node->GetLabel(), childIndex, node->IsWindowNode());
+		int c = 0;
+		for (CustomLayoutNode* child : node->GetChildren()) if (child) AppendNodeRows(child, row, depth + 1, c++);
+		m_rows[row].subtreeEnd = (int)m_rows.size();
+	}
+
+	void LayoutTreeView::AppendFlatRows(int flatNode, int parent, int depth, int childIndex) {
+		const int row = AppendRow(nullptr, flatNode, parent, depth, m_flat->GetLabel(flatNode), childIndex, m_flat->IsWindowNode(flatNode));
+		int c = 0;
+		for (int n = m_flat->GetFirstChild(flatNode); n >= 0; n = m_flat->GetNextSibling(n)) AppendFlatRows(n, row, depth + 1, c++);
+		m_rows[row].subtreeEnd = (int)m_rows.size();
+	}
+
+	int LayoutTreeView::AppendRow(CustomLayoutNode* node, int flatNode, int parent, int depth, const std::string& label, int childIndex, bool isWindow) {
+		Row row;
+		row.node = node;
+		row.flatNode = flatNode;
+		row.parent = parent;
+		row.subtreeEnd = -1;
+		row.depth = depth;
+		row.labelOffset = (int)m_labels.size();
+		row.id = node ? ImHashData(&node, sizeof(node)) : ImHashData(&flatNode, sizeof(flatNode));
+		row.isWindow = isWindow;
+		row.matchSelf = row.matchAny = true;
+
+		if (label.empty()) {
+			char fallback[32];
+			const int len = ImFormatString(fallback, IM_ARRAYSIZE(fallback), "Child %d", childIndex);
+			m_labels.insert(m_labels.end(), fallback, fallback + len + 1);
+		}
+		else m_labels.insert(m_labels.end(), label.c_str(), label.c_str() + label.size() + 1);
+
+		m_rows.push_back(row);
+		return (int)m_rows.size() - 1;
+	}
+
+	// A narrowing edit (the new filter contains the old one) can only drop
+	// matches, so only the current matches are tested again.
+	void LayoutTreeView::ApplyFilter(bool narrowing) {
+		const bool filtering = IsFiltering();
+		for (Row& row : m_rows) {
+			if (!filtering) row.matchSelf = true;
+			else if (!narrowing || row.matchSelf) row.matchSelf = ImStristr(Label(row), nullptr, m_filter, nullptr) != nullptr;
+			row.matchAny = row.matchSelf;
+		}
+		// children come after their parent, so one backward sweep marks every
+		// ancestor of a match
+		for (int i = (int)m_rows.size() - 1; i >= 0; --i)
+			if (m_rows[i].matchAny && m_rows[i].parent >= 0) m_rows[m_rows[i].parent].matchAny = true;
+		ImStrncpy(m_appliedFilter, m_filter, IM_ARRAYSIZE(m_appliedFilter));
+		m_visibleRowsDirty = true;
+	}
+
+	void LayoutTreeView::RebuildVisibleRows() {
+		m_visibleRows.clear();
+		const bool filtering = IsFiltering();
+		for (int i = 0; i < (int)m_rows.size();) {
+			const Row& row = m_rows[i];
+			if (filtering && !row.matchAny) { i = row.subtreeEnd; continue; }
+			m_visibleRows.push_back(i);
+			const bool collapsed = !filtering && !row.isWindow && !m_expanded.GetBool(row.id, row.depth == 0);
+			i = collapsed ? row.subtreeEnd : i + 1;
+		}
+		m_visibleRowsDirty = false;
+	}
+
+	bool LayoutTreeView::IsRowVisible(const Row& row) const {
+		return row.node ? row.node->IsVisibleFlag() : m_flat->IsVisibleFlag(row.flatNode);
+	}
+
+	bool LayoutTreeView::IsRowEffectivelyVisible(const Row& row) const {
+		for (const Row* r = &row; ; r = &m_rows[r->parent]) {
+			if (!(r->node ? r->node->IsEffectivelyVisible() : m_flat->IsEffectivelyVisible(r->flatNode))) return false;
+			if (r->parent < 0) return true;
+		}
+	}
+
+	// Showing a node also shows its ancestors so it actually appears.
+	void LayoutTreeView::SetRowVisible(int rowIndex, bool visible) {
+		for (int i = rowIndex; i >= 0; i = m_rows[i].parent) {
+			Row& row = m_rows[i];
+			if (i != rowIndex && IsRowVisible(row)) break;
+			if (row.node) row.node->SetVisible(visible);
+			else m_flat->SetVisible(row.flatNode, visible);
+			if (!visible) break;
+		}
+	}
+
+	void LayoutTreeView::SetMatchesVisible(bool visible) {
+		for (int i = 0; i < (int)m_rows.size(); ++i)
+			if (m_rows[i].matchSelf) SetRowVisible(i, visible);
+	}
+
+	void LayoutTreeView::Draw() {
+		if (!m_rowsValid || m_builtVersion != CurrentVersion()) RebuildRows();
+
+		ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10.f);
+		if (ImGui::InputTextWithHint("##filter", "Search", m_filter, IM_ARRAYSIZE(m_filter)))
+			ApplyFilter(m_appliedFilter[0] && strstr(m_filter, m_appliedFilter) != nullptr);
+		ImGui::SameLine();
+		if (ImGui::Button("Show")) SetMatchesVisible(true);
+		ImGui::SameLine();
+		if (ImGui::Button("Hide")) SetMatchesVisible(false);
+
+		if (m_visibleRowsDirty) RebuildVisibleRows();
+		const int count = (int)m_visibleRows.size();
+		const float rowHeight = ImGui::GetFrameHeightWithSpacing();
+		const ImVec2 size(ImGui::GetFontSize() * 18.f, rowHeight * (float)ImClamp(count, 1, 16) + ImGui::GetStyle().WindowPadding.y);
+		if (ImGui::BeginChild("##tree", size, ImGuiChildFlags_Borders)) {
+			ImGuiListClipper clipper;
+			clipper.Begin(count, rowHeight);
+			while (clipper.Step())
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) DrawRow(m_visibleRows[i]);
+		}
+		ImGui::EndChild();
+	}
+
+	bool LayoutTreeView::TakePendingMove(CustomLayoutNode*& node, CustomLayoutNode*& parent, int& index) {
+		if (!m_moveNode) return false;
+		node = m_moveNode;
+		parent = m_moveParent;
+		index = m_moveIndex;
+		m_moveNode = m_moveParent = nullptr;
+		return true;
+	}
+
+	void LayoutTreeView::DrawRow(int rowIndex) {
+		const Row& row = m_rows[rowIndex];
+		ImGui::PushOverrideID(row.id);
+		ImGui::SetCursorPosX(ImGui::GetCursorPosX() + row.depth * ImGui::GetStyle().IndentSpacing);
+
+		bool visible = IsRowVisible(row);
+		if (ImGui::Checkbox("##visible", &visible)) SetRowVisible(rowIndex, visible);
+		ImGui::SameLine();
+
+		const bool dimmed = !IsRowEffectivelyVisible(row);
+		if (dimmed) ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+		const ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+		if (row.isWindow) {
+			ImGui::TreeNodeEx("##node", flags | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_Bullet, "%s", Label(row));
+			// window nodes can be dropped on a splitter row or onto the layout
+			if (row.node && ImGui::BeginDragDropSource()) {
+				ImGui::SetDragDropPayload(PaneDragPayload, &row.node, sizeof(row.node));
+				ImGui::TextUnformatted(Label(row));
+				ImGui::EndDragDropSource();
+			}
+		}
+		else {
+			// matches are always expanded while filtering
+			const bool filtering = IsFiltering();
+			const bool expanded = filtering || m_expanded.GetBool(row.id, row.depth == 0);
+			ImGui::SetNextItemOpen(expanded);
+			const bool open = ImGui::TreeNodeEx("##node", flags, "%s", Label(row));
+			if (open != expanded && !filtering) {
+				m_expanded.SetBool(row.id, open);
+				m_visibleRowsDirty = true;
+			}
+			if (row.node && ImGui::BeginDragDropTarget()) {
+				if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload(PaneDragPayload)) {
+					CustomLayoutNode* dragged;
+					memcpy(&dragged, payload->Data, sizeof(dragged));
+					// appended as the last child; rows are rebuilt next frame
+					if (m_root->IsAncestorOf(dragged)) {
+						m_moveNode = dragged;
+						m_moveParent = row.node;
+						m_moveIndex = (int)row.node->GetChildren().size();
+					}
+				}
+				ImGui::EndDragDropTarget();
+			}
+		}
+		if (dimmed) ImGui::PopStyleColor();
+		ImGui::PopID();
+	}
+
+} // namespace FrameGUILayout
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "FrameGUILayout.h"
+
+namespace FrameGUILayout {
+
+	class FlatLayoutTree;
+
+	// Tree view of a layout for the Layout Control panel. The tree is flattened
+	// into rows with precomputed IDs and labels only when its structure changes;
+	// drawing goes through ImGuiListClipper, so only the rows on screen cost
+	// anything. The search box filters by label (case-insensitive) and keeps the
+	// ancestors of every match; Show/Hide apply to all matching nodes. A frame
+	// without structure, filter or expansion changes does not allocate.
+	class LayoutTreeView {
+	public:
+		explicit LayoutTreeView(CustomLayoutNode* root);
+		explicit LayoutTreeView(FlatLayoutTree* tree);
+
+		// Draws into the current window.
+		void Draw();
+		// Frees the rows; they are rebuilt on the next Draw.
+		void Release();
+		// A pane dropped on a splitter row during the last Draw, to be moved by
+		// the layout so it can relay out only what changed.
+		bool TakePendingMove(CustomLayoutNode*& node, CustomLayoutNode*& parent, int& index);
+
+	private:
+		struct Row {
+			CustomLayoutNode* node;   // set for CustomLayoutNode trees
+			int flatNode;             // set for FlatLayoutTree
+			int parent;               // row index, -1 for top-level rows
+			int subtreeEnd;           // one past the last descendant row
+			int depth;
+			int labelOffset;          // into m_labels
+			ImGuiID id;
+			bool isWindow;
+			bool matchSelf;
+			bool matchAny;            // the row or one of its descendants matches
+		};
+
+		void RebuildRows();
+		void AppendNodeRows(CustomLayoutNode* node, int parent, int depth, int childIndex);
+		void AppendFlatRows(int flatNode, int parent, int depth, int childIndex);
+		int AppendRow(CustomLayoutNode* node, int flatNode, int parent, int depth, const std::string& label, int childIndex, bool isWindow);
+		void ApplyFilter(bool narrowing);
+		void RebuildVisibleRows();
+		void DrawRow(int rowIndex);
+		bool IsRowVisible(const Row& row) const;
+		bool IsRowEffectivelyVisible(const Row& row) const;
+		void SetRowVisible(int rowIndex, bool visible);
+		void SetMatchesVisible(bool visible);
+		unsigned int CurrentVersion() const;
+		bool IsFiltering() const { return m_filter[0] != 0; }
+		const char* Label(const Row& row) const { return m_labels.data() + row.labelOffset; }
+
+		CustomLayoutNode* m_root = nullptr;
+		FlatLayoutTree* m_flat = nullptr;
+		std::vector<Row> m_rows;             // depth-first, parents before children
+		std::vector<char> m_labels;          // zero-terminated labels of all rows
+		std::vector<int> m_visibleRows;      // rows passed to the clipper
+		ImGuiStorage m_expanded;             // by row ID, survives rebuilds
+		unsigned int m_builtVersion = 0;
+		bool m_rowsValid = false;
+		bool m_visibleRowsDirty = true;
+		char m_filter[64] = {};
+		char m_appliedFilter[64] = {};
+		CustomLayoutNode* m_moveNode = nullptr;
+		CustomLayoutNode* m_moveParent = nullptr;
+		int m_moveIndex = 0;
+	};
+
+} // namespace FrameGUILayout
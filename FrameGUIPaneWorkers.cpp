@@ -0,0 +1,66 @@
+#include "FrameGUIPaneWorkers.h"
+
+namespace FrameGUILayout {
+
+	PaneWorkerPool::PaneWorkerPool(int workerCount) {
+		assert(workerCount > 0 && "Worker pool needs at least one worker");
+		m_threads.reserve(workerCount);
+		for (int i = 0; i < workerCount; ++i) m_threads.emplace_back(&PaneWorkerPool::WorkerMain, this);
+	}
+
+	PaneWorkerPool::~PaneWorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& t : m_threads) t.join();
+	}
+
+	int PaneWorkerPool::WorkerCount() const { return (int)m_threads.size(); }
+
+	int PaneWorkerPool::DefaultWorkerCount() {
+		const int hw = (int)std::thread::hardware_concurrency();
+		return hw > 1 ? hw - 1 : 1;
+	}
+
+	void PaneWorkerPool::Run(PanePrepareJob* jobs, int count, float dt) {
+		if (count <= 0) return;
+		if (count == 1) { jobs[0].func->Prepare(dt, jobs[0].rect); return; }
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs = jobs;
+			m_count = count;
+			m_dt = dt;
+			m_next.store(0, std::memory_order_relaxed);
+			m_busy = (int)m_threads.size();
+			++m_generation;
+		}
+		m_wake.notify_all();
+		Drain();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return m_busy == 0; });
+		m_jobs = nullptr;
+	}
+
+	void PaneWorkerPool::Drain() {
+		for (int i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count; i = m_next.fetch_add(1, std::memory_order_relaxed))
+			m_jobs[i].func->Prepare(m_dt, m_jobs[i].rect);
+	}
+
+	void PaneWorkerPool::WorkerMain() {
+		unsigned int seen = 0;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;) {
+			m_wake.wait(lock, [&] { return m_quit || m_generation != seen; });
+			if (m_quit) return;
+			seen = m_generation;
+			lock.unlock();
+			Drain();
+			lock.lock();
+			if (--m_busy == 0) m_done.notify_one();
+		}
+	}
+
+} // namespace FrameGUILayout
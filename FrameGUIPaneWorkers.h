@@ -0,0 +1,49 @@
+#pragma once
+
+#include "FrameGUILayout.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace FrameGUILayout {
+
+	// Fixed set of worker threads that run the Prepare phase of two-phase panes.
+	// Jobs are handed out one at a time from a shared counter, so a frame waits
+	// for the slowest pane rather than for the sum of all panes. Run() does not
+	// allocate.
+	class PaneWorkerPool {
+	public:
+		explicit PaneWorkerPool(int workerCount);
+		~PaneWorkerPool();
+		PaneWorkerPool(const PaneWorkerPool&) = delete;
+		PaneWorkerPool& operator=(const PaneWorkerPool&) = delete;
+
+		int WorkerCount() const;
+
+		// Calls Prepare on every job and returns once all of them finished. The
+		// calling thread takes jobs too.
+		void Run(PanePrepareJob* jobs, int count, float dt);
+
+		// One worker per hardware thread besides the caller's.
+		static int DefaultWorkerCount();
+
+	private:
+		void WorkerMain();
+		void Drain();
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+		unsigned int m_generation = 0;
+		int m_busy = 0;
+		bool m_quit = false;
+
+		PanePrepareJob* m_jobs = nullptr;
+		int m_count = 0;
+		float m_dt = 0.f;
+		std::atomic<int> m_next{ 0 };
+	};
+
+} // namespace FrameGUILayout
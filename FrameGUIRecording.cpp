@@ -0,0 +1,635 @@
+#include "FrameGUIRecording.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace FrameGUILayout {
+
+	static_assert(sizeof(double) == 8 && sizeof(int64_t) == 8, "Recording columns store 8-byte values");
+
+	static const char* const s_columnNames[RecordingColumn_COUNT] = {
+		"frame_id", "mBeginTime", "mDeltaTime", "lat", "lon", "alt", "yaw_dur", "pitch_dur", "roll_dur"
+	};
+
+	static constexpr size_t ColumnAlign = 64;
+
+	static size_t AlignUp(size_t v, size_t a) { return (v + a - 1) & ~(a - 1); }
+
+	const char* FrameRecording::ColumnName(RecordingColumn column) {
+		assert(column >= 0 && column < RecordingColumn_COUNT && "Invalid recording column");
+		return s_columnNames[column];
+	}
+
+	bool FrameRecording::IsIntColumn(RecordingColumn column) {
+		return column <= RecordingColumn_DeltaTime;
+	}
+
+	static double FrameValue(const RecordedFrame& f, int column) {
+		switch (column) {
+		case RecordingColumn_FrameId: return (double)f.FrameId;
+		case RecordingColumn_BeginTime: return (double)f.BeginTime;
+		case RecordingColumn_DeltaTime: return (double)f.DeltaTime;
+		case RecordingColumn_Lat: return f.Lat;
+		case RecordingColumn_Lon: return f.Lon;
+		case RecordingColumn_Alt: return f.Alt;
+		case RecordingColumn_YawDur: return f.YawDur;
+		case RecordingColumn_PitchDur: return f.PitchDur;
+		default: return f.RollDur;
+		}
+	}
+
+	static void WriteFrameValue(unsigned char* dst, const RecordedFrame& f, int column) {
+		switch (column) {
+		case RecordingColumn_FrameId: memcpy(dst, &f.FrameId, 8); break;
+		case RecordingColumn_BeginTime: memcpy(dst, &f.BeginTime, 8); break;
+		case RecordingColumn_DeltaTime: memcpy(dst, &f.DeltaTime, 8); break;
+		default: { const double v = FrameValue(f, column); memcpy(dst, &v, 8); } break;
+		}
+	}
+
+	static bool SeekFile(FILE* f, uint64_t offset) {
+#ifdef _WIN32
+		return _fseeki64(f, (__int64)offset, SEEK_SET) == 0;
+#else
+		return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+	}
+
+	// Writes a recording of a known frame count one block of frames at a time,
+	// into a memory image or straight to a file, so only a block of frames
+	// and the per-block stats and index are held at once.
+	class FrameRecording::Writer {
+	public:
+		explicit Writer(size_t frameCount) : m_frameCount(frameCount) {
+			m_blocks = (frameCount + BlockFrames - 1) / BlockFrames;
+			size_t offset = AlignUp(sizeof(Header) + sizeof(ColumnEntry) * RecordingColumn_COUNT, ColumnAlign);
+			for (int c = 0; c < RecordingColumn_COUNT; ++c) {
+				m_columnOffsets[c] = offset;
+				offset = AlignUp(offset + sizeof(double) * frameCount, ColumnAlign);
+			}
+			m_statsOffset = offset;
+			m_indexOffset = m_statsOffset + sizeof(BlockStats) * m_blocks * RecordingColumn_COUNT;
+			m_stats.resize(m_blocks * RecordingColumn_COUNT);
+			m_index.resize(m_blocks);
+			m_block.reserve(std::min(frameCount, (size_t)BlockFrames));
+			m_values.resize(sizeof(double) * std::min(frameCount, (size_t)BlockFrames));
+		}
+
+		size_t TotalBytes() const { return m_indexOffset + sizeof(BlockIndex) * m_blocks; }
+
+		// Starts writing into image, which must hold TotalBytes() zeroed bytes, or
+		// else into file.
+		bool Begin(unsigned char* image, FILE* file) {
+			m_image = image;
+			m_file = file;
+			Header h;
+			h.magic = Magic;
+			h.version = Version;
+			h.headerSize = (uint16_t)sizeof(Header);
+			h.columnCount = RecordingColumn_COUNT;
+			h.blockFrames = BlockFrames;
+			h.frameCount = (uint64_t)m_frameCount;
+			h.statsOffset = m_statsOffset;
+			h.indexOffset = m_indexOffset;
+			ColumnEntry entries[RecordingColumn_COUNT] = {};
+			for (int c = 0; c < RecordingColumn_COUNT; ++c) {
+				strncpy(entries[c].name, s_columnNames[c], sizeof(entries[c].name) - 1);
+				entries[c].isInt = IsIntColumn((RecordingColumn)c) ? 1 : 0;
+				entries[c].offset = m_columnOffsets[c];
+			}
+			return WriteAt(0, &h, sizeof(h)) && WriteAt(sizeof(Header), entries, sizeof(entries));
+		}
+
+		bool Add(const RecordedFrame& f) {
+			assert(m_written + m_block.size() < m_frameCount && "More frames than the recording was sized for");
+			m_block.push_back(f);
+			return m_block.size() < BlockFrames || FlushBlock();
+		}
+
+		// Writes the last partial block, the stats and the index.
+		bool Finish() {
+			assert(m_written + m_block.size() == m_frameCount && "Fewer frames than the recording was sized for");
+			if (!m_block.empty() && !FlushBlock()) return false;
+			// the index ends the file, which also sizes it past the column padding
+			return WriteAt(m_statsOffset, m_stats.data(), sizeof(BlockStats) * m_stats.size()) &&
+				WriteAt(m_indexOffset, m_index.data(), sizeof(BlockIndex) * m_index.size());
+		}
+
+	private:
+		bool WriteAt(size_t offset, const void* data, size_t size) {
+			if (size == 0) return true;
+			if (m_image) { memcpy(m_image + offset, data, size); return true; }
+			return SeekFile(m_file, offset) && fwrite(data, 1, size, m_file) == size;
+		}
+
+		bool FlushBlock() {
+			const size_t b = m_written / BlockFrames;
+			const size_t n = m_block.size();
+			m_index[b] = BlockIndex{ m_block[0].FrameId, m_block[0].BeginTime };
+			for (int c = 0; c < RecordingColumn_COUNT; ++c) {
+				BlockStats st{ FrameValue(m_block[0], c), FrameValue(m_block[0], c) };
+				for (size_t i = 0; i < n; ++i) {
+					WriteFrameValue(m_values.data() + sizeof(double) * i, m_block[i], c);
+					const double v = FrameValue(m_block[i], c);
+					st.min = std::min(st.min, v);
+					st.max = std::max(st.max, v);
+				}
+				m_stats[c * m_blocks + b] = st;
+				if (!WriteAt(m_columnOffsets[c] + sizeof(double) * m_written, m_values.data(), sizeof(double) * n)) return false;
+			}
+			m_written += n;
+			m_block.clear();
+			return true;
+		}
+
+		size_t m_frameCount;
+		unsigned char* m_image = nullptr;
+		FILE* m_file = nullptr;
+		size_t m_blocks = 0;
+		size_t m_columnOffsets[RecordingColumn_COUNT];
+		size_t m_statsOffset = 0;
+		size_t m_indexOffset = 0;
+		size_t m_written = 0;               // frames already in the columns
+		std::vector<RecordedFrame> m_block;
+		std::vector<unsigned char> m_values; // one column of the block
+		std::vector<BlockStats> m_stats;    // [column][block]
+		std::vector<BlockIndex> m_index;
+	};
+
+	// FindFrame and LowerBoundTime binary-search these two columns.
+	static bool FollowsInOrder(const RecordedFrame& prev, const RecordedFrame& f) {
+		return f.FrameId > prev.FrameId && f.BeginTime >= prev.BeginTime;
+	}
+
+	void FrameRecording::Save(const RecordedFrame* frames, int count, ImVector<unsigned char>& out) {
+		assert(count >= 0 && (frames != nullptr || count == 0) && "Invalid frame range");
+		Writer w((size_t)count);
+		const size_t total = w.TotalBytes();
+		assert(total <= (size_t)INT_MAX && "Recording does not fit in an ImVector, use SaveFile");
+		out.resize((int)total);
+		memset(out.Data, 0, total);
+		w.Begin(out.Data, nullptr);
+		for (int i = 0; i < count; ++i) {
+			assert((i == 0 || FollowsInOrder(frames[i - 1], frames[i])) && "Frames must be in frame_id and mBeginTime order");
+			w.Add(frames[i]);
+		}
+		w.Finish();
+	}
+
+	bool FrameRecording::SaveFile(const char* path, const RecordedFrame* frames, int count) {
+		assert(count >= 0 && (frames != nullptr || count == 0) && "Invalid frame range");
+		FILE* f = fopen(path, "wb");
+		if (!f) return false;
+		Writer w((size_t)count);
+		bool ok = w.Begin(nullptr, f);
+		for (int i = 0; ok && i < count; ++i) {
+			assert((i == 0 || FollowsInOrder(frames[i - 1], frames[i])) && "Frames must be in frame_id and mBeginTime order");
+			ok = w.Add(frames[i]);
+		}
+		ok = ok && w.Finish();
+		return fclose(f) == 0 && ok;
+	}
+
+	// Minimal reader for the flat array of numeric objects the recorder writes.
+	// Reads from a text in memory or, with a file, refills the buffer from it
+	// as it goes, so a file is parsed without loading it.
+	struct RecordingJsonReader {
+		const char* p;
+		const char* end;
+		FILE* file = nullptr;
+		char* buffer = nullptr;
+		size_t capacity = 0;
+		bool failed = false;   // a read error, as opposed to the end of the file
+
+		bool More() {
+			if (p < end) return true;
+			if (!file || failed) return false;
+			const size_t n = fread(buffer, 1, capacity, file);
+			if (n == 0 && ferror(file)) failed = true;
+			p = buffer;
+			end = buffer + n;
+			return n > 0;
+		}
+		void SkipSpace() { while (More() && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p; }
+		bool Consume(char c) {
+			SkipSpace();
+			if (!More() || *p != c) return false;
+			++p;
+			return true;
+		}
+		bool Peek(char c) { SkipSpace(); return More() && *p == c; }
+
+		// Key strings only; escapes are kept as-is, no column name has one. The
+		// key is copied out, cut to the key buffer; outLength is its full length.
+		bool String(char* key, size_t keySize, size_t& outLength) {
+			if (!Consume('"')) return false;
+			outLength = 0;
+			while (More() && *p != '"') {
+				const int n = *p == '\\' ? 2 : 1;
+				for (int k = 0; k < n && More(); ++k, ++p, ++outLength)
+					if (outLength < keySize) key[outLength] = *p;
+			}
+			if (!More()) return false;
+			++p;
+			return true;
+		}
+		bool SkipString() { char key[1]; size_t l; return String(key, 0, l); }
+
+		// Numbers are copied out so strtod never reads past the end of the text.
+		bool Number(double& outValue, int64_t& outInt, bool& outIsInt) {
+			SkipSpace();
+			char buf[64];
+			size_t n = 0;
+			while (More() && n < sizeof(buf) - 1 && strchr("+-0123456789.eE", *p)) buf[n++] = *p++;
+			if (n == 0) return false;
+			buf[n] = 0;
+			char* stop = nullptr;
+			outValue = strtod(buf, &stop);
+			if (stop != buf + n) return false;
+			outIsInt = strcspn(buf, ".eE") == n;
+			outInt = outIsInt ? strtoll(buf, nullptr, 10) : (int64_t)outValue;
+			return true;
+		}
+
+		// Skips the value of an unknown key, nested or not.
+		bool SkipValue() {
+			SkipSpace();
+			if (!More()) return false;
+			if (*p == '"') return SkipString();
+			if (*p != '{' && *p != '[') {
+				while (More() && *p != ',' && *p != '}' && *p != ']') ++p;
+				return More();
+			}
+			int depth = 0;
+			while (More()) {
+				if (*p == '"') { if (!SkipString()) return false; continue; }
+				if (*p == '{' || *p == '[') ++depth;
+				else if ((*p == '}' || *p == ']') && --depth == 0) { ++p; return true; }
+				++p;
+			}
+			return false;
+		}
+	};
+
+	static int ColumnOfKey(const char* key, size_t length) {
+		for (int c = 0; c < RecordingColumn_COUNT; ++c)
+			if (strlen(s_columnNames[c]) == length && memcmp(s_columnNames[c], key, length) == 0) return c;
+		return -1;
+	}
+
+	// Calls onFrame for every frame of the array, stopping with false at the
+	// first malformed one or when onFrame returns false.
+	template <typename OnFrame>
+	static bool ReadJsonFrames(RecordingJsonReader& r, OnFrame&& onFrame) {
+		if (!r.Consume('[')) return false;
+		if (r.Consume(']')) return true;
+		do {
+			if (!r.Consume('{')) return false;
+			RecordedFrame f{};
+			unsigned seen = 0;
+			if (!r.Peek('}')) {
+				do {
+					char key[16];
+					size_t length;
+					if (!r.String(key, sizeof(key), length) || !r.Consume(':')) return false;
+					const int c = length <= sizeof(key) ? ColumnOfKey(key, length) : -1;
+					if (c < 0) { if (!r.SkipValue()) return false; continue; }
+					double v;
+					int64_t i;
+					bool isInt;
+					if (!r.Number(v, i, isInt)) return false;
+					switch (c) {
+					case RecordingColumn_FrameId: f.FrameId = i; break;
+					case RecordingColumn_BeginTime: f.BeginTime = i; break;
+					case RecordingColumn_DeltaTime: f.DeltaTime = i; break;
+					case RecordingColumn_Lat: f.Lat = v; break;
+					case RecordingColumn_Lon: f.Lon = v; break;
+					case RecordingColumn_Alt: f.Alt = v; break;
+					case RecordingColumn_YawDur: f.YawDur = v; break;
+					case RecordingColumn_PitchDur: f.PitchDur = v; break;
+					default: f.RollDur = v; break;
+					}
+					seen |= 1u << c;
+				} while (r.Consume(','));
+			}
+			if (!r.Consume('}')) return false;
+			if (seen != (1u << RecordingColumn_COUNT) - 1) return false;
+			if (!onFrame(f)) return false;
+		} while (r.Consume(','));
+		return r.Consume(']');
+	}
+
+	bool FrameRecording::ParseJson(const char* text, size_t size, ImVector<RecordedFrame>& out) {
+		out.resize(0);
+		RecordingJsonReader r{ text, text + size };
+		return ReadJsonFrames(r, [&out](const RecordedFrame& f) { out.push_back(f); return true; });
+	}
+
+	// Two passes over the file: the first validates it and counts the frames,
+	// which places every column, the second writes the frames a block at a
+	// time. Neither the text nor the frames are held in memory.
+	bool FrameRecording::ConvertJsonFile(const char* jsonPath, const char* recordingPath) {
+		FILE* in = fopen(jsonPath, "rb");
+		if (!in) return false;
+		std::vector<char> buffer(1 << 16);
+		RecordingJsonReader r{ nullptr, nullptr, in, buffer.data(), buffer.size() };
+
+		size_t count = 0;
+		RecordedFrame prev{};
+		const bool valid = ReadJsonFrames(r, [&](const RecordedFrame& f) {
+			if (count > 0 && !FollowsInOrder(prev, f)) return false;
+			prev = f;
+			return ++count <= (size_t)INT_MAX;
+		});
+		if (!valid || r.failed) { fclose(in); return false; }
+
+		FILE* out = fopen(recordingPath, "wb");
+		if (!out) { fclose(in); return false; }
+		rewind(in);
+		r = RecordingJsonReader{ nullptr, nullptr, in, buffer.data(), buffer.size() };
+		Writer w(count);
+		bool ok = w.Begin(nullptr, out) && ReadJsonFrames(r, [&w](const RecordedFrame& f) { return w.Add(f); }) && !r.failed && w.Finish();
+		fclose(in);
+		ok = fclose(out) == 0 && ok;
+		if (!ok) remove(recordingPath);
+		return ok;
+	}
+
+	FrameRecording::~FrameRecording() {
+		Close();
+	}
+
+	bool FrameRecording::Open(const char* path) {
+		Close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		const void* view = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+			// the view keeps the mapping alive after both handles are closed
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping) {
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+		if (!view) return false;
+		const size_t size = (size_t)fileSize.QuadPart;
+#else
+		const int fd = open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		void* view = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+			view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (view == MAP_FAILED) return false;
+		const size_t size = (size_t)st.st_size;
+#endif
+		m_mapped = true;
+		if (Bind((const unsigned char*)view, size)) return true;
+		Close();
+		return false;
+	}
+
+	bool FrameRecording::OpenMemory(const void* data, size_t size) {
+		Close();
+		if (!data || ((uintptr_t)data & (sizeof(double) - 1)) != 0) return false;
+		if (Bind((const unsigned char*)data, size)) return true;
+		Close();
+		return false;
+	}
+
+	void FrameRecording::Close() {
+		if (m_mapped) {
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+#else
+			munmap((void*)m_data, m_size);
+#endif
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_mapped = false;
+		for (int c = 0; c < RecordingColumn_COUNT; ++c) { m_columns[c] = nullptr; m_stats[c] = nullptr; }
+		m_index = nullptr;
+		m_frameCount = 0;
+		m_blockCount = 0;
+		m_blockFrames = BlockFrames;
+	}
+
+	bool FrameRecording::Bind(const unsigned char* data, size_t size) {
+		m_data = data;
+		m_size = size;
+		if (size < sizeof(Header)) return false;
+		Header h;
+		memcpy(&h, data, sizeof(h));
+		if (h.magic != Magic || h.version != Version || h.headerSize < sizeof(Header)) return false;
+		if (h.blockFrames == 0 || h.columnCount == 0 || h.frameCount > (uint64_t)INT_MAX) return false;
+		if ((uint64_t)h.headerSize + (uint64_t)sizeof(ColumnEntry) * h.columnCount > size) return false;
+
+		const uint64_t blocks = (h.frameCount + h.blockFrames - 1) / h.blockFrames;
+		const uint64_t columnBytes = sizeof(double) * h.frameCount;
+		if (h.statsOffset % sizeof(double) != 0 || h.statsOffset > size || sizeof(BlockStats) * blocks * h.columnCount > size - h.statsOffset) return false;
+		if (h.indexOffset % sizeof(double) != 0 || h.indexOffset > size || sizeof(BlockIndex) * blocks > size - h.indexOffset) return false;
+
+		// columns are looked up by name, so a file may carry extra ones
+		int found = 0;
+		for (uint32_t i = 0; i < h.columnCount; ++i) {
+			ColumnEntry e;
+			memcpy(&e, data + h.headerSize + sizeof(ColumnEntry) * i, sizeof(e));
+			e.name[sizeof(e.name) - 1] = 0;
+			const int c = ColumnOfKey(e.name, strlen(e.name));
+			if (c < 0) continue;
+			if (m_columns[c] || (e.isInt != 0) != IsIntColumn((RecordingColumn)c)) return false;
+			if (e.offset % sizeof(double) != 0 || e.offset > size || columnBytes > size - e.offset) return false;
+			m_columns[c] = data + e.offset;
+			m_stats[c] = (const BlockStats*)(data + h.statsOffset) + blocks * i;
+			++found;
+		}
+		if (found != RecordingColumn_COUNT) return false;
+
+		m_index = (const BlockIndex*)(data + h.indexOffset);
+		m_frameCount = (int)h.frameCount;
+		m_blockCount = (int)blocks;
+		m_blockFrames = h.blockFrames;
+		return true;
+	}
+
+	bool FrameRecording::IsOpen() const {
+		return m_index != nullptr;
+	}
+
+	int FrameRecording::FrameCount() const {
+		return m_frameCount;
+	}
+
+	const int64_t* FrameRecording::Ints(RecordingColumn column) const {
+		assert(IsIntColumn(column) && "Column holds doubles");
+		return (const int64_t*)m_columns[column];
+	}
+
+	const double* FrameRecording::Doubles(RecordingColumn column) const {
+		assert(column > RecordingColumn_DeltaTime && column < RecordingColumn_COUNT && "Column holds integers");
+		return (const double*)m_columns[column];
+	}
+
+	double FrameRecording::Value(RecordingColumn column, int row) const {
+		assert(row >= 0 && row < m_frameCount && "Row out of range");
+		return IsIntColumn(column) ? (double)Ints(column)[row] : Doubles(column)[row];
+	}
+
+	int FrameRecording::BlockCount() const {
+		return m_blockCount;
+	}
+
+	double FrameRecording::BlockMin(RecordingColumn column, int block) const {
+		assert(block >= 0 && block < m_blockCount && "Block out of range");
+		return m_stats[column][block].min;
+	}
+
+	double FrameRecording::BlockMax(RecordingColumn column, int block) const {
+		assert(block >= 0 && block < m_blockCount && "Block out of range");
+		return m_stats[column][block].max;
+	}
+
+	// Four independent lanes so the compares do not wait on each other.
+	template <typename T>
+	static void ScanRange(const T* values, int first, int last, double& outMin, double& outMax) {
+		double mn[4] = { outMin, outMin, outMin, outMin };
+		double mx[4] = { outMax, outMax, outMax, outMax };
+		int i = first;
+		for (; i + 4 <= last; i += 4) {
+			for (int k = 0; k < 4; ++k) {
+				const double v = (double)values[i + k];
+				mn[k] = v < mn[k] ? v : mn[k];
+				mx[k] = v > mx[k] ? v : mx[k];
+			}
+		}
+		for (; i < last; ++i) {
+			const double v = (double)values[i];
+			mn[0] = v < mn[0] ? v : mn[0];
+			mx[0] = v > mx[0] ? v : mx[0];
+		}
+		outMin = std::min(std::min(mn[0], mn[1]), std::min(mn[2], mn[3]));
+		outMax = std::max(std::max(mx[0], mx[1]), std::max(mx[2], mx[3]));
+	}
+
+	static void ScanColumn(const FrameRecording& rec, RecordingColumn column, int first, int last, double& outMin, double& outMax) {
+		if (FrameRecording::IsIntColumn(column)) ScanRange(rec.Ints(column), first, last, outMin, outMax);
+		else ScanRange(rec.Doubles(column), first, last, outMin, outMax);
+	}
+
+	void FrameRecording::ColumnRange(RecordingColumn column, int first, int last, double& outMin, double& outMax) const {
+		first = std::max(first, 0);
+		last = std::min(last, m_frameCount);
+		outMin = std::numeric_limits<double>::infinity();
+		outMax = -std::numeric_limits<double>::infinity();
+		while (first < last) {
+			const int block = BlockOfRow(first);
+			const int blockEnd = std::min(m_frameCount, (block + 1) * (int)m_blockFrames);
+			if (first == block * (int)m_blockFrames && blockEnd <= last) {
+				outMin = std::min(outMin, m_stats[column][block].min);
+				outMax = std::max(outMax, m_stats[column][block].max);
+			}
+			else {
+				ScanColumn(*this, column, first, std::min(blockEnd, last), outMin, outMax);
+			}
+			first = blockEnd;
+		}
+	}
+
+	int FrameRecording::FindFrame(int64_t frameId) const {
+		if (m_blockCount == 0) return -1;
+		const BlockIndex* b = std::upper_bound(m_index, m_index + m_blockCount, frameId, [](int64_t v, const BlockIndex& e) { return v < e.firstFrameId; });
+		if (b == m_index) return -1;
+		const int block = (int)(b - m_index) - 1;
+		const int64_t* ids = Ints(RecordingColumn_FrameId);
+		const int64_t* first = ids + block * (int)m_blockFrames;
+		const int64_t* last = ids + std::min(m_frameCount, (block + 1) * (int)m_blockFrames);
+		const int64_t* it = std::lower_bound(first, last, frameId);
+		return (it != last && *it == frameId) ? (int)(it - ids) : -1;
+	}
+
+	int FrameRecording::LowerBoundTime(int64_t beginTime) const {
+		if (m_blockCount == 0) return 0;
+		// the first block whose start is not before beginTime; the answer is in the block before it
+		const BlockIndex* b = std::lower_bound(m_index, m_index + m_blockCount, beginTime, [](const BlockIndex& e, int64_t v) { return e.firstBeginTime < v; });
+		if (b == m_index) return 0;
+		const int block = (int)(b - m_index) - 1;
+		const int64_t* times = Ints(RecordingColumn_BeginTime);
+		const int64_t* first = times + block * (int)m_blockFrames;
+		const int64_t* last = times + std::min(m_frameCount, (block + 1) * (int)m_blockFrames);
+		return (int)(std::lower_bound(first, last, beginTime) - times);
+	}
+
+	int RecordingSeries::PointCount() const {
+		if (GroupRows <= 1) return Rows;
+		return 2 * ((Rows + GroupRows - 1) / GroupRows);
+	}
+
+	ImPlotPoint RecordingSeries::Getter(int idx, void* data) {
+		RecordingSeries& s = *static_cast<RecordingSeries*>(data);
+		const int64_t* times = s.Recording->Ints(RecordingColumn_BeginTime);
+		const double scale = 1.0 / FrameRecording::TicksPerSecond;
+		if (s.GroupRows <= 1) {
+			const int row = s.First + idx;
+			return ImPlotPoint((double)(times[row] - times[0]) * scale, s.Recording->Value(s.Column, row));
+		}
+		// even points are the group minimum, odd points its maximum
+		const int group = idx / 2;
+		const int first = s.First + group * s.GroupRows;
+		if (group != s.CachedGroup) {
+			s.CachedGroup = group;
+			s.CachedMin = std::numeric_limits<double>::infinity();
+			s.CachedMax = -s.CachedMin;
+			s.Recording->ColumnRange(s.Column, first, std::min(first + s.GroupRows, s.First + s.Rows), s.CachedMin, s.CachedMax);
+		}
+		return ImPlotPoint((double)(times[first] - times[0]) * scale, (idx & 1) ? s.CachedMax : s.CachedMin);
+	}
+
+	static int64_t SecondsToTicks(double seconds, int64_t origin) {
+		// clamped well inside int64 so an unbounded axis cannot overflow
+		const double ticks = std::min(std::max(seconds * FrameRecording::TicksPerSecond, -4e18), 4e18);
+		return origin + (int64_t)ticks;
+	}
+
+	void PlotRecordingLine(const char* label, const FrameRecording& recording, RecordingColumn column, ImPlotLineFlags flags) {
+		if (!recording.IsOpen() || recording.FrameCount() == 0) return;
+		const ImPlotRect limits = ImPlot::GetPlotLimits();
+		const int64_t origin = recording.Ints(RecordingColumn_BeginTime)[0];
+		// one row of margin on each side keeps the line running to the plot edges
+		const int first = std::max(0, recording.LowerBoundTime(SecondsToTicks(limits.X.Min, origin)) - 1);
+		const int last = std::min(recording.FrameCount(), recording.LowerBoundTime(SecondsToTicks(limits.X.Max, origin)) + 1);
+		if (last <= first) return;
+
+		const int width = std::max(1, (int)ImPlot::GetPlotSize().x);
+		const int rows = last - first;
+		RecordingSeries series{ &recording, column, first, rows, rows > 2 * width ? (rows + width - 1) / width : 1 };
+		ImPlot::PlotLineG(label, &RecordingSeries::Getter, &series, series.PointCount(), flags);
+	}
+
+} // namespace FrameGUILayout
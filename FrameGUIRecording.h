@@ -0,0 +1,161 @@
+#pragma once
+
+#include "imgui.h"
+#include "implot.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace FrameGUILayout {
+
+	// Columns of a saved session, in file order. The first three are int64
+	// (mBeginTime and mDeltaTime in microseconds), the rest double.
+	enum RecordingColumn {
+		RecordingColumn_FrameId,
+		RecordingColumn_BeginTime,
+		RecordingColumn_DeltaTime,
+		RecordingColumn_Lat,
+		RecordingColumn_Lon,
+		RecordingColumn_Alt,
+		RecordingColumn_YawDur,
+		RecordingColumn_PitchDur,
+		RecordingColumn_RollDur,
+		RecordingColumn_COUNT
+	};
+
+	// One frame of a session, as in save/frame_data_*.json.
+	struct RecordedFrame {
+		int64_t FrameId;
+		int64_t BeginTime;
+		int64_t DeltaTime;
+		double Lat;
+		double Lon;
+		double Alt;
+		double YawDur;
+		double PitchDur;
+		double RollDur;
+	};
+
+	// Columnar, memory-mapped session recording. The file is a header, a
+	// column table, every column as one contiguous 64-byte aligned array of
+	// 8-byte values, per-block min/max of every column and a per-block index
+	// of the first frame id and begin time; values are in host (little-endian)
+	// byte order. Open() maps the file and the column pointers point straight
+	// into the mapping, so nothing is copied or parsed on load.
+	class FrameRecording {
+	public:
+		static constexpr uint32_t Magic = 0x43524746; // "FGRC"
+		static constexpr uint16_t Version = 1;
+		static constexpr uint32_t BlockFrames = 4096;
+		static constexpr double TicksPerSecond = 1e6; // mBeginTime and mDeltaTime
+
+		// Frames must be in increasing frame_id and non-decreasing mBeginTime
+		// order. Save() builds the image in memory (below 2 GB); SaveFile()
+		// writes it to the file one block of frames at a time.
+		static void Save(const RecordedFrame* frames, int count, ImVector<unsigned char>& out);
+		static bool SaveFile(const char* path, const RecordedFrame* frames, int count);
+
+		// Reads the pretty-printed JSON array written by the session recorder.
+		// Unknown keys are skipped; a frame missing one of the columns fails.
+		static bool ParseJson(const char* text, size_t size, ImVector<RecordedFrame>& out);
+		// Streams the file through the parser; fails, writing nothing, if the
+		// frames are not in the order above.
+		static bool ConvertJsonFile(const char* jsonPath, const char* recordingPath);
+
+		static const char* ColumnName(RecordingColumn column);
+		static bool IsIntColumn(RecordingColumn column);
+
+		FrameRecording() = default;
+		~FrameRecording();
+		FrameRecording(const FrameRecording&) = delete;
+		FrameRecording& operator=(const FrameRecording&) = delete;
+
+		// Maps the file read-only. Fails, leaving the recording closed, if the
+		// file is not a valid recording of this version.
+		bool Open(const char* path);
+		// Uses a recording image owned by the caller, e.g. the output of Save().
+		bool OpenMemory(const void* data, size_t size);
+		void Close();
+		bool IsOpen() const;
+
+		int FrameCount() const;
+		const int64_t* Ints(RecordingColumn column) const;
+		const double* Doubles(RecordingColumn column) const;
+		double Value(RecordingColumn column, int row) const;
+
+		int BlockCount() const;
+		double BlockMin(RecordingColumn column, int block) const;
+		double BlockMax(RecordingColumn column, int block) const;
+		// Min and max over rows [first, last); whole blocks come from the stats.
+		void ColumnRange(RecordingColumn column, int first, int last, double& outMin, double& outMax) const;
+
+		// Row of the frame, or -1. Uses the block index, then searches one block.
+		int FindFrame(int64_t frameId) const;
+		// First row whose mBeginTime is not before beginTime.
+		int LowerBoundTime(int64_t beginTime) const;
+
+	private:
+		class Writer;
+
+		struct Header {
+			uint32_t magic;
+			uint16_t version;
+			uint16_t headerSize;
+			uint32_t columnCount;
+			uint32_t blockFrames;
+			uint64_t frameCount;
+			uint64_t statsOffset;   // [column][block] min, max
+			uint64_t indexOffset;   // [block] first frame id, first begin time
+		};
+		struct ColumnEntry {
+			char name[16];
+			uint32_t isInt;
+			uint32_t reserved;
+			uint64_t offset;
+		};
+		struct BlockStats {
+			double min;
+			double max;
+		};
+		struct BlockIndex {
+			int64_t firstFrameId;
+			int64_t firstBeginTime;
+		};
+
+		bool Bind(const unsigned char* data, size_t size);
+		int BlockOfRow(int row) const { return row / (int)m_blockFrames; }
+
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		bool m_mapped = false;   // unmapped by Close()
+		const void* m_columns[RecordingColumn_COUNT] = {};
+		const BlockStats* m_stats[RecordingColumn_COUNT] = {};
+		const BlockIndex* m_index = nullptr;
+		int m_frameCount = 0;
+		int m_blockCount = 0;
+		uint32_t m_blockFrames = BlockFrames;
+	};
+
+	// Rows [First, First + Rows) of one column against mBeginTime in seconds
+	// since the first frame, reduced to a min and a max point per group of
+	// GroupRows rows when the range is wider than the plot.
+	struct RecordingSeries {
+		const FrameRecording* Recording;
+		RecordingColumn Column;
+		int First;
+		int Rows;
+		int GroupRows;
+		// the group last scanned; its min and max points are read one after the other
+		int CachedGroup = -1;
+		double CachedMin = 0.0;
+		double CachedMax = 0.0;
+
+		int PointCount() const;
+		static ImPlotPoint Getter(int idx, void* data);
+	};
+
+	// Plots a column over the rows inside the current plot's x limits (seconds
+	// since the first frame) with at most two points per pixel column, read
+	// directly from the mapping. Call between BeginPlot/EndPlot.
+	void PlotRecordingLine(const char* label, const FrameRecording& recording, RecordingColumn column, ImPlotLineFlags flags = 0);
+
+} // namespace FrameGUILayout
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "FrameGUIStreamBuffers.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace FrameGUILayout {
+
+	// One sample of a channel, as pushed by an acquisition thread.
+	struct StreamSample {
+		double X;
+		double Y;
+	};
+
+	struct SampleQueueStats {
+		uint64_t Pushed = 0;    // accepted by the queue
+		uint64_t Dropped = 0;   // rejected because the queue was full
+		int HighWater = 0;      // largest number of samples drained at once
+		int Capacity = 0;
+	};
+
+	// Lock-free single-producer/single-consumer ring of samples between an
+	// acquisition thread and the UI thread. The producer never blocks: a push
+	// into a full queue drops the samples and counts them. The consumer drains
+	// everything that accumulated since its last drain in one go, as at most
+	// two contiguous spans, typically from a two-phase pane's Prepare.
+	//
+	// Head and tail live on separate cache lines, and the producer caches the
+	// tail, so a push reads the consumer's line only when the queue looks full.
+	template <typename T = StreamSample>
+	class SampleQueue {
+		static_assert(std::is_trivially_copyable<T>::value, "Queued samples must be trivially copyable");
+
+	public:
+		// The capacity is rounded up to a power of two.
+		explicit SampleQueue(int capacity = 4096) {
+			assert(capacity > 0 && "Queue capacity must be positive");
+			m_capacity = 1;
+			while (m_capacity < (uint32_t)capacity) m_capacity <<= 1;
+			m_data = static_cast<T*>(IM_ALLOC(sizeof(T) * m_capacity));
+		}
+		~SampleQueue() { IM_FREE(m_data); }
+		SampleQueue(const SampleQueue&) = delete;
+		SampleQueue& operator=(const SampleQueue&) = delete;
+
+		// Producer side. Returns false and counts a drop if the queue is full.
+		bool Push(const T& sample) { return PushBatch(&sample, 1) == 1; }
+
+		// Producer side. Pushes as many samples as fit and returns that count;
+		// the rest are counted as dropped.
+		int PushBatch(const T* samples, int count) {
+			const uint32_t head = m_head.load(std::memory_order_relaxed);
+			uint32_t room = m_capacity - (head - m_producerTail);
+			if (room < (uint32_t)count) {
+				m_producerTail = m_tail.load(std::memory_order_acquire);
+				room = m_capacity - (head - m_producerTail);
+			}
+			const uint32_t n = std::min(room, (uint32_t)count);
+			CopyIn(head, samples, n);
+			m_head.store(head + n, std::memory_order_release);
+			m_pushed.store(m_pushed.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+			if (n < (uint32_t)count) m_dropped.store(m_dropped.load(std::memory_order_relaxed) + (count - n), std::memory_order_relaxed);
+			return (int)n;
+		}
+
+		// Consumer side. Calls sink(const T* samples, int count) once or twice
+		// with everything pushed so far, oldest first, and returns the total.
+		template <typename F>
+		int Drain(F&& sink) {
+			const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+			const uint32_t head = m_head.load(std::memory_order_acquire);
+			const uint32_t n = head - tail;
+			if (n == 0) return 0;
+			const uint32_t first = tail & (m_capacity - 1);
+			const uint32_t run = std::min(n, m_capacity - first);
+			sink(m_data + first, (int)run);
+			if (run < n) sink(m_data, (int)(n - run));
+			m_tail.store(head, std::memory_order_release);
+			m_highWater = std::max(m_highWater, (int)n);
+			return (int)n;
+		}
+
+		// Consumer side. Appends everything pushed so far to a plot buffer.
+		template <typename TX, typename TY>
+		int DrainInto(StreamingBuffer<TX, TY>& buffer) {
+			static_assert(std::is_same<T, StreamSample>::value, "DrainInto needs StreamSample queues");
+			return Drain([&](const StreamSample* s, int count) { for (int i = 0; i < count; ++i) buffer.AddPoint((TX)s[i].X, (TY)s[i].Y); });
+		}
+		template <typename TY>
+		int DrainInto(SweepBuffer<TY>& buffer) {
+			static_assert(std::is_same<T, StreamSample>::value, "DrainInto needs StreamSample queues");
+			return Drain([&](const StreamSample* s, int count) { for (int i = 0; i < count; ++i) buffer.AddPoint(s[i].X, (TY)s[i].Y); });
+		}
+
+		// Consumer side; the counters are read without stopping the producer.
+		SampleQueueStats GetStats() const {
+			SampleQueueStats stats;
+			stats.Pushed = m_pushed.load(std::memory_order_relaxed);
+			stats.Dropped = m_dropped.load(std::memory_order_relaxed);
+			stats.HighWater = m_highWater;
+			stats.Capacity = (int)m_capacity;
+			return stats;
+		}
+		int Capacity() const { return (int)m_capacity; }
+
+	private:
+		void CopyIn(uint32_t head, const T* samples, uint32_t n) {
+			const uint32_t first = head & (m_capacity - 1);
+			const uint32_t run = std::min(n, m_capacity - first);
+			memcpy(m_data + first, samples, sizeof(T) * run);
+			if (run < n) memcpy(m_data, samples + run, sizeof(T) * (n - run));
+		}
+
+		// shared, read-mostly
+		T* m_data = nullptr;
+		uint32_t m_capacity = 0;
+
+		// producer line
+		alignas(64) std::atomic<uint32_t> m_head{ 0 };
+		uint32_t m_producerTail = 0;
+		std::atomic<uint64_t> m_pushed{ 0 };
+		std::atomic<uint64_t> m_dropped{ 0 };
+
+		// consumer line
+		alignas(64) std::atomic<uint32_t> m_tail{ 0 };
+		int m_highWater = 0;
+	};
+
+} // namespace FrameGUILayout
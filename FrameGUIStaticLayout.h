@@ -0,0 +1,378 @@
+#pragma once
+
+#include "FrameGUILayout.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+// Compile-time layout description, e.g.
+//
+//   static constexpr char YawLabel[] = "Yaw";
+//   using AttitudeStrip = FrameGUILayout::HSplit<
+//       FrameGUILayout::VSplit<FrameGUILayout::Pane<&YawStrip, YawLabel>, FrameGUILayout::Pane<&PitchStrip>>,
+//       FrameGUILayout::Pane<&RollStrip>>;
+//   static FrameGUILayout::StaticLayout<AttitudeStrip> layout;
+//
+// The shape is checked by static_asserts, all node state lives in fixed-size
+// arrays inside StaticLayout (no heap allocation) and pane functions are
+// template arguments, so they are called directly instead of through a
+// function pointer. Nodes are numbered in preorder, the root is 0. Splits are
+// sized and dragged by the same SplitMath as CustomLayoutNode, including its
+// pixel constraints. Use CustomLayoutNode for layouts built at runtime;
+// BuildNodeTree<Desc>() converts a description into one.
+
+namespace FrameGUILayout {
+
+	namespace StaticLayoutDetail {
+
+		enum NodeKind : uint8_t { NodeKind_Horizontal, NodeKind_Vertical, NodeKind_Window };
+
+		inline constexpr char DefaultPaneLabel[] = "Window";
+
+		template <int N>
+		struct Topology {
+			int parent[N] = {};
+			int firstChild[N] = {};
+			int nextSibling[N] = {};
+			uint8_t kind[N] = {};
+			const char* label[N] = {};
+		};
+
+		template <typename T>
+		struct IsLayoutNode : std::false_type {};
+
+		template <bool Vertical, typename... Children>
+		struct Split {
+			static_assert(sizeof...(Children) > 0, "A split needs at least one child");
+			static_assert((IsLayoutNode<Children>::value && ...), "Split children must be Pane, HSplit or VSplit");
+
+			static constexpr int ChildCount = sizeof...(Children);
+			static constexpr int NodeCount = 1 + (Children::NodeCount + ...);
+			static constexpr int PaneCount = (Children::PaneCount + ...);
+			static constexpr int MaxChildCount = std::max({ ChildCount, Children::MaxChildCount... });
+
+			template <typename T>
+			static constexpr void Fill(T& t, int index, int parent) {
+				t.parent[index] = parent;
+				t.kind[index] = Vertical ? NodeKind_Vertical : NodeKind_Horizontal;
+				t.label[index] = Vertical ? "Vertical" : "Horizontal";
+				t.firstChild[index] = index + 1;
+				t.nextSibling[index] = -1;
+				int child = index + 1;
+				int prev = -1;
+				((Children::Fill(t, child, index),
+					(prev >= 0 ? (void)(t.nextSibling[prev] = child) : (void)0),
+					prev = child,
+					child += Children::NodeCount), ...);
+			}
+
+			template <typename L>
+			static void RenderPanes(const L& layout, int index) {
+				if (!layout.IsActive(index)) return;
+				int child = index + 1;
+				((Children::RenderPanes(layout, child), child += Children::NodeCount), ...);
+			}
+
+			static CustomLayoutNode* BuildNodeTree() {
+				auto* node = new CustomLayoutNode(Vertical);
+				if (Vertical) (node->AddVerticalChild(Children::BuildNodeTree()), ...);
+				else (node->AddHorizontalChild(Children::BuildNodeTree()), ...);
+				return node;
+			}
+		};
+
+	} // namespace StaticLayoutDetail
+
+	// Label is shown in the layout tree view; it must have static storage
+	// duration, e.g. a constexpr char array.
+	template <void (*Func)(), const char* Label = StaticLayoutDetail::DefaultPaneLabel>
+	struct Pane {
+		static_assert(Func != nullptr, "Pane needs a window function");
+
+		static constexpr int NodeCount = 1;
+		static constexpr int PaneCount = 1;
+		static constexpr int MaxChildCount = 0;
+
+		template <typename T>
+		static constexpr void Fill(T& t, int index, int parent) {
+			t.parent[index] = parent;
+			t.kind[index] = StaticLayoutDetail::NodeKind_Window;
+			t.label[index] = Label;
+			t.firstChild[index] = -1;
+			t.nextSibling[index] = -1;
+		}
+
+		template <typename L>
+		static void RenderPanes(const L& layout, int index) {
+			if (!layout.IsActive(index)) return;
+			ImGui::SetNextWindowPos(layout.GetDomainPos(index));
+			ImGui::SetNextWindowSize(layout.GetDomainSize(index));
+			Func();
+		}
+
+		static CustomLayoutNode* BuildNodeTree() { return new CustomLayoutNode(Func, Label); }
+	};
+
+	template <typename... Children>
+	struct HSplit : StaticLayoutDetail::Split<false, Children...> {};
+
+	template <typename... Children>
+	struct VSplit : StaticLayoutDetail::Split<true, Children...> {};
+
+	namespace StaticLayoutDetail {
+		template <void (*Func)(), const char* Label> struct IsLayoutNode<Pane<Func, Label>> : std::true_type {};
+		template <typename... C> struct IsLayoutNode<HSplit<C...>> : std::true_type {};
+		template <typename... C> struct IsLayoutNode<VSplit<C...>> : std::true_type {};
+	}
+
+	// Converts a static description into a runtime CustomLayoutNode tree.
+	template <typename Desc>
+	CustomLayoutNode* BuildNodeTree() {
+		static_assert(StaticLayoutDetail::IsLayoutNode<Desc>::value, "Desc must be Pane, HSplit or VSplit");
+		return Desc::BuildNodeTree();
+	}
+
+	template <typename Desc>
+	class StaticLayout {
+		static_assert(StaticLayoutDetail::IsLayoutNode<Desc>::value, "Desc must be Pane, HSplit or VSplit");
+
+	public:
+		static constexpr int NodeCount = Desc::NodeCount;
+		static constexpr int PaneCount = Desc::PaneCount;
+
+		StaticLayout() {
+			m_flags.fill(Flags_Visible);
+			m_ratio.fill(0.f);
+			m_visibleCount.fill(0);
+			m_lastVisibleCount.fill(0);
+			m_domainPos.fill(ImVec2(0, 0));
+			m_domainSize.fill(ImVec2(0, 0));
+		}
+
+		// Pixel limits along the parent's split axis, as on CustomLayoutNode.
+		void SetSizeConstraints(int node, float minSize, float maxSize = FLT_MAX) {
+			m_constraints[node].MinSize = ImMax(minSize, 0.f);
+			m_constraints[node].MaxSize = ImMax(maxSize, m_constraints[node].MinSize);
+			m_dirty = true;
+		}
+		void SetFixedSize(int node, float size) {
+			m_constraints[node].FixedSize = ImMax(size, 0.f);
+			m_dirty = true;
+		}
+		const LayoutConstraints& GetConstraints(int node) const { return m_constraints[node]; }
+		const char* GetLabel(int node) const { return s_topology.label[node]; }
+
+		void SetVisible(int node, bool v) {
+			if (HasFlag(node, Flags_Visible) == v) return;
+			if (v) m_flags[node] |= Flags_Visible; else m_flags[node] &= ~Flags_Visible;
+			m_dirty = true;
+		}
+		bool IsVisibleFlag(int node) const { return HasFlag(node, Flags_Visible); }
+		bool IsActive(int node) const { return HasFlag(node, Flags_Active); }
+		bool IsWindowNode(int node) const { return s_topology.kind[node] == StaticLayoutDetail::NodeKind_Window; }
+		bool IsVerticalSplitter(int node) const { return s_topology.kind[node] == StaticLayoutDetail::NodeKind_Vertical; }
+		ImVec2 GetDomainPos(int node) const { return m_domainPos[node]; }
+		ImVec2 GetDomainSize(int node) const { return m_domainSize[node]; }
+
+		void Layout(ImVec2 pos, ImVec2 size) {
+			RefreshVisibility();
+			m_domainPos[0] = pos; m_domainSize[0] = size;
+			for (int i = 0; i < NodeCount; ++i) {
+				const int parent = s_topology.parent[i];
+				const bool active = HasFlag(i, Flags_EffectiveVisible) && (parent < 0 || HasFlag(parent, Flags_Active));
+				if (active) m_flags[i] |= Flags_Active; else m_flags[i] &= ~Flags_Active;
+				if (!active || IsWindowNode(i)) continue;
+				LayoutChildren(i);
+			}
+			m_dirty = false;
+		}
+
+		void RenderPanes() const { Desc::RenderPanes(*this, 0); }
+
+		void RenderSplitters() const {
+			ImDrawList* dl = ImGui::GetForegroundDrawList();
+			for (int i = 0; i < NodeCount; ++i) {
+				if (IsWindowNode(i) || !IsActive(i)) continue;
+				const ImVec2 p = m_domainPos[i], s = m_domainSize[i];
+				int k = 0;
+				for (int c = s_topology.firstChild[i]; c >= 0 && k < m_visibleCount[i] - 1; c = s_topology.nextSibling[c]) {
+					if (!HasFlag(c, Flags_EffectiveVisible)) continue;
+					if (IsVerticalSplitter(i)) {
+						const float b = m_domainPos[c].y + m_domainSize[c].y;
+						dl->AddLine(ImVec2(p.x, b), ImVec2(p.x + s.x, b), IM_COL32(100, 100, 100, 255), m_splitterWidth);
+					}
+					else {
+						const float b = m_domainPos[c].x + m_domainSize[c].x;
+						dl->AddLine(ImVec2(b, p.y), ImVec2(b, p.y + s.y), IM_COL32(100, 100, 100, 255), m_splitterWidth);
+					}
+					++k;
+				}
+			}
+		}
+
+		bool FindHoveredSplitter(const ImVec2& mousePos, int& outNode, int& outBoundaryIndex) const {
+			outNode = -1; outBoundaryIndex = -1;
+			const float pad = 8.f;
+			for (int i = 0; i < NodeCount; ++i) {
+				if (IsWindowNode(i) || !IsActive(i)) continue;
+				const bool vertical = IsVerticalSplitter(i);
+				const ImVec2 p = m_domainPos[i], s = m_domainSize[i];
+				if (vertical ? (mousePos.x < p.x || mousePos.x > p.x + s.x) : (mousePos.y < p.y || mousePos.y > p.y + s.y)) continue;
+				int k = 0;
+				for (int c = s_topology.firstChild[i]; c >= 0 && k < m_visibleCount[i] - 1; c = s_topology.nextSibling[c]) {
+					if (!HasFlag(c, Flags_EffectiveVisible)) continue;
+					const float b = vertical ? m_domainPos[c].y + m_domainSize[c].y : m_domainPos[c].x + m_domainSize[c].x;
+					const float m = vertical ? mousePos.y : mousePos.x;
+					if (m >= b - pad && m <= b + pad) { outNode = i; outBoundaryIndex = k; return true; }
+					++k;
+				}
+			}
+			return false;
+		}
+
+		bool HandleSplitterDragAt(int node, int boundaryIndex, const ImVec2& mouseDelta) {
+			if (node < 0 || boundaryIndex < 0 || IsWindowNode(node) || !IsActive(node)) return false;
+			if (boundaryIndex >= m_visibleCount[node] - 1) return false;
+			int iA = -1, iB = -1, k = 0;
+			for (int c = s_topology.firstChild[node]; c >= 0; c = s_topology.nextSibling[c]) {
+				if (!HasFlag(c, Flags_EffectiveVisible)) continue;
+				if (k == boundaryIndex) iA = c;
+				else if (k == boundaryIndex + 1) { iB = c; break; }
+				++k;
+			}
+			if (iA < 0 || iB < 0) return false;
+
+			VisibleRatioSum(node);
+			const bool vertical = IsVerticalSplitter(node);
+			const float sizeA = vertical ? m_domainSize[iA].y : m_domainSize[iA].x;
+			const float sizeB = vertical ? m_domainSize[iB].y : m_domainSize[iB].x;
+			if (!SplitMath::DragBoundary(sizeA, sizeA + sizeB, m_constraints[iA], m_constraints[iB],
+				vertical ? mouseDelta.y : mouseDelta.x, m_ratio[iA], m_ratio[iB])) return false;
+			m_dirty = true;
+			return true;
+		}
+
+		void UpdateAndRender() {
+			ImVec2 mousePos = ImGui::GetMousePos();
+			if (!ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+				m_activeNode = -1; m_activeBoundaryIndex = -1;
+				FindHoveredSplitter(mousePos, m_activeNode, m_activeBoundaryIndex);
+			}
+			if (m_activeNode >= 0) {
+				ImGui::SetMouseCursor(IsVerticalSplitter(m_activeNode) ? ImGuiMouseCursor_ResizeNS : ImGuiMouseCursor_ResizeEW);
+			}
+			if (ImGui::IsMouseDragging(ImGuiMouseButton_Left) && m_activeNode >= 0) {
+				if (HandleSplitterDragAt(m_activeNode, m_activeBoundaryIndex, ImGui::GetMouseDragDelta()))
+					ImGui::ResetMouseDragDelta();
+			}
+
+			ImGuiViewport* vp = ImGui::GetMainViewport();
+			if (m_dirty || vp->WorkPos.x != m_domainPos[0].x || vp->WorkPos.y != m_domainPos[0].y ||
+				vp->WorkSize.x != m_domainSize[0].x || vp->WorkSize.y != m_domainSize[0].y)
+				Layout(vp->WorkPos, vp->WorkSize);
+
+			RenderPanes();
+			RenderSplitters();
+		}
+
+	private:
+		enum Flags : uint8_t {
+			Flags_Visible          = 1 << 0,
+			Flags_EffectiveVisible = 1 << 1,
+			Flags_Active           = 1 << 2,
+		};
+
+		static constexpr StaticLayoutDetail::Topology<NodeCount> BuildTopology() {
+			StaticLayoutDetail::Topology<NodeCount> t{};
+			Desc::Fill(t, 0, -1);
+			return t;
+		}
+		static constexpr StaticLayoutDetail::Topology<NodeCount> s_topology = BuildTopology();
+		static constexpr int MaxChildCount = Desc::MaxChildCount;
+
+		bool HasFlag(int node, uint8_t f) const { return (m_flags[node] & f) != 0; }
+
+		// preorder: children always follow their parent, so a reverse sweep
+		// counts visible children before their parent is evaluated
+		void RefreshVisibility() {
+			if (!m_dirty) return;
+			m_visibleCount.fill(0);
+			for (int i = NodeCount - 1; i >= 0; --i) {
+				const bool eff = HasFlag(i, Flags_Visible) && (IsWindowNode(i) || m_visibleCount[i] > 0);
+				if (eff) m_flags[i] |= Flags_EffectiveVisible; else m_flags[i] &= ~Flags_EffectiveVisible;
+				if (eff && s_topology.parent[i] >= 0) ++m_visibleCount[s_topology.parent[i]];
+			}
+			for (int i = 0; i < NodeCount; ++i) {
+				if (IsWindowNode(i) || m_visibleCount[i] == m_lastVisibleCount[i]) continue;
+				m_lastVisibleCount[i] = m_visibleCount[i];
+				if (m_visibleCount[i] == 0) continue;
+				const float eq = 1.f / (float)m_visibleCount[i];
+				for (int c = s_topology.firstChild[i]; c >= 0; c = s_topology.nextSibling[c])
+					m_ratio[c] = HasFlag(c, Flags_EffectiveVisible) ? eq : 0.f;
+			}
+		}
+
+		void LayoutChildren(int node) {
+			const float sum = VisibleRatioSum(node);
+			int n = 0;
+			bool constrained = false;
+			for (int c = s_topology.firstChild[node]; c >= 0; c = s_topology.nextSibling[c]) {
+				if (!HasFlag(c, Flags_EffectiveVisible)) continue;
+				m_splitChildren[n++] = c;
+				constrained |= !m_constraints[c].IsDefault();
+			}
+
+			const bool vertical = IsVerticalSplitter(node);
+			const ImVec2 p = m_domainPos[node], s = m_domainSize[node];
+			const float start = vertical ? p.y : p.x;
+			const float extent = vertical ? s.y : s.x;
+			auto weight = [this](int k) { return m_ratio[m_splitChildren[k]]; };
+			float* e = m_splitEdges.data();
+			if (constrained)
+				SplitMath::SolveEdges(n, start, extent, weight,
+					[this](int k) -> const LayoutConstraints& { return m_constraints[m_splitChildren[k]]; },
+					e, m_solverScratch.data());
+			else {
+				SplitMath::Offsets(n, sum, weight, e);
+				SplitMath::OffsetEdges(n, start, extent, e, e);
+			}
+
+			for (int k = 0; k < n; ++k) {
+				const int c = m_splitChildren[k];
+				if (vertical) { m_domainPos[c] = ImVec2(p.x, e[k]); m_domainSize[c] = ImVec2(s.x, e[k + 1] - e[k]); }
+				else { m_domainPos[c] = ImVec2(e[k], p.y); m_domainSize[c] = ImVec2(e[k + 1] - e[k], s.y); }
+			}
+		}
+
+		float VisibleRatioSum(int node) {
+			float sum = 0.f;
+			for (int c = s_topology.firstChild[node]; c >= 0; c = s_topology.nextSibling[c])
+				if (HasFlag(c, Flags_EffectiveVisible)) sum += m_ratio[c];
+			if (sum <= 1e-6f) {
+				const float eq = 1.f / (float)(m_visibleCount[node] > 0 ? m_visibleCount[node] : 1);
+				for (int c = s_topology.firstChild[node]; c >= 0; c = s_topology.nextSibling[c])
+					if (HasFlag(c, Flags_EffectiveVisible)) m_ratio[c] = eq;
+				sum = 1.f;
+			}
+			return sum;
+		}
+
+		std::array<uint8_t, NodeCount> m_flags;
+		std::array<float, NodeCount> m_ratio;
+		std::array<int, NodeCount> m_visibleCount;
+		std::array<int, NodeCount> m_lastVisibleCount;
+		std::array<ImVec2, NodeCount> m_domainPos;
+		std::array<ImVec2, NodeCount> m_domainSize;
+		std::array<LayoutConstraints, NodeCount> m_constraints;
+		// LayoutChildren scratch: visible children, their edges, solver sums
+		std::array<int, MaxChildCount + 1> m_splitChildren;
+		std::array<float, MaxChildCount + 1> m_splitEdges;
+		std::array<float, 4 * (MaxChildCount + 1)> m_solverScratch;
+		float m_splitterWidth = 1.0f;
+		bool m_dirty = true;
+		int m_activeNode = -1;
+		int m_activeBoundaryIndex = -1;
+	};
+
+} // namespace FrameGUILayout
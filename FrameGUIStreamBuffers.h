@@ -0,0 +1,411 @@
+#pragma once
+
+#include "imgui.h"
+#include "implot.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace FrameGUILayout {
+
+	// Fixed-capacity stream of (x, y) samples for realtime plots, kept as two
+	// separate columns. Every sample is written twice, at i and i + capacity,
+	// so the newest Size() samples are always one contiguous span of each
+	// column: X() and Y() are plain arrays, oldest first, and ImPlot reads them
+	// without a wrap offset or stride. Use double (or int64 ticks) for TX on
+	// streams that run for hours; float timestamps lose sub-frame precision
+	// after about a day.
+	//
+	// Storage is allocated on the first AddPoint and freed by Release(), so a
+	// buffer that never receives data costs nothing.
+	template <typename TX = double, typename TY = TX>
+	class StreamingBuffer {
+		static_assert(std::is_trivially_copyable<TX>::value && std::is_trivially_copyable<TY>::value, "Stream columns must be trivially copyable");
+
+	public:
+		StreamingBuffer() : StreamingBuffer(2000) {}
+		explicit StreamingBuffer(int capacity) : m_capacity(capacity) {
+			assert(capacity > 0 && "Stream capacity must be positive");
+		}
+		StreamingBuffer(const StreamingBuffer& other) : m_capacity(other.m_capacity) { CopyFrom(other); }
+		StreamingBuffer(StreamingBuffer&& other) noexcept : m_capacity(other.m_capacity) { Swap(other); }
+		StreamingBuffer& operator=(StreamingBuffer other) noexcept { Swap(other); return *this; }
+		~StreamingBuffer() { if (m_data) IM_FREE(m_data); }
+
+		void AddPoint(TX x, TY y) {
+			if (!m_data) Allocate();
+			TX* xs = Xs();
+			TY* ys = Ys();
+			xs[m_head] = xs[m_head + m_capacity] = x;
+			ys[m_head] = ys[m_head + m_capacity] = y;
+			if (++m_head == m_capacity) m_head = 0;
+			if (m_size < m_capacity) ++m_size;
+		}
+
+		// Drops the samples and keeps the storage.
+		void Erase() { m_size = 0; m_head = 0; }
+		// Frees the storage; returns the bytes released.
+		size_t Release() {
+			const size_t bytes = m_data ? StorageBytes() : 0;
+			if (m_data) IM_FREE(m_data);
+			m_data = nullptr;
+			Erase();
+			return bytes;
+		}
+
+		int Size() const { return m_size; }
+		int Capacity() const { return m_capacity; }
+		bool Empty() const { return m_size == 0; }
+
+		// Size() contiguous samples, oldest first. Valid until the next AddPoint.
+		const TX* X() const { return m_data ? Xs() + First() : nullptr; }
+		const TY* Y() const { return m_data ? Ys() + First() : nullptr; }
+		TX BackX() const { assert(m_size > 0 && "Stream is empty"); return X()[m_size - 1]; }
+		TY BackY() const { assert(m_size > 0 && "Stream is empty"); return Y()[m_size - 1]; }
+
+		// ImPlotGetter for columns of different types:
+		//   ImPlot::PlotLineG("x", &Buffer::Getter, &buf, buf.Size());
+		static ImPlotPoint Getter(int idx, void* data) {
+			const StreamingBuffer* buf = static_cast<const StreamingBuffer*>(data);
+			return ImPlotPoint((double)buf->X()[idx], (double)buf->Y()[idx]);
+		}
+
+	private:
+		int First() const { return m_size < m_capacity ? 0 : m_head; }
+
+		// the y column starts after 2 * capacity x values, aligned for TY
+		size_t YOffset() const {
+			const size_t a = alignof(TY);
+			return ((size_t)m_capacity * 2 * sizeof(TX) + a - 1) / a * a;
+		}
+		size_t StorageBytes() const { return YOffset() + (size_t)m_capacity * 2 * sizeof(TY); }
+		TX* Xs() const { return reinterpret_cast<TX*>(m_data); }
+		TY* Ys() const { return reinterpret_cast<TY*>(static_cast<char*>(m_data) + YOffset()); }
+
+		void Allocate() { m_data = IM_ALLOC(StorageBytes()); }
+		void CopyFrom(const StreamingBuffer& other) {
+			if (!other.m_data) return;
+			Allocate();
+			memcpy(m_data, other.m_data, StorageBytes());
+			m_size = other.m_size;
+			m_head = other.m_head;
+		}
+		void Swap(StreamingBuffer& other) noexcept {
+			std::swap(m_data, other.m_data);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_size, other.m_size);
+			std::swap(m_head, other.m_head);
+		}
+
+		void* m_data = nullptr;
+		int m_capacity = 0;
+		int m_size = 0;
+		int m_head = 0;   // next write slot in [0, capacity)
+	};
+
+	// Oscilloscope-style rolling window: x is taken modulo the span and mapped
+	// to one of a fixed number of buckets, each holding the min and max of the
+	// samples that fell into it during the current sweep. A sample overwrites
+	// its bucket in place, so appends are O(1) and memory never grows with the
+	// input rate; the buckets ahead of the cursor keep the previous sweep.
+	// X()/Y() are 2 points per bucket (min, max); PlotSweepLine merges
+	// neighbouring buckets down to 2 points per pixel column of the plot, so
+	// a spike of a single sample still reaches the screen at any plot width.
+	// Buckets that received no sample are NaN; PlotSweepLine skips them and
+	// leaves a gap at the cursor.
+	template <typename T = double>
+	class SweepBuffer {
+		static_assert(std::is_floating_point<T>::value, "Sweep columns use NaN for empty buckets");
+
+	public:
+		SweepBuffer() : SweepBuffer(10.f) {}
+		explicit SweepBuffer(float span, int bucketCount = 1024) : m_span(span), m_buckets(bucketCount) {
+			assert(span > 0.f && bucketCount > 0 && "Sweep span and bucket count must be positive");
+		}
+		SweepBuffer(const SweepBuffer& other) : m_span(other.m_span), m_buckets(other.m_buckets), m_cursor(other.m_cursor), m_sweep(other.m_sweep) {
+			if (!other.m_data) return;
+			m_data = static_cast<T*>(IM_ALLOC(StorageBytes()));
+			memcpy(m_data, other.m_data, StorageBytes());
+		}
+		SweepBuffer(SweepBuffer&& other) noexcept : m_span(other.m_span), m_buckets(other.m_buckets) { Swap(other); }
+		SweepBuffer& operator=(SweepBuffer other) noexcept { Swap(other); return *this; }
+		~SweepBuffer() { if (m_data) IM_FREE(m_data); }
+
+		void AddPoint(double x, T y) {
+			if (!m_data) Allocate();
+			const double q = x / m_span;
+			const double sweep = floor(q);
+			const int bucket = std::min((int)((q - sweep) * m_buckets), m_buckets - 1);
+			T* ys = m_data + 2 * m_buckets;
+			// buckets passed over since the last sample had no data this sweep
+			const double steps = m_cursor < 0 ? 0.0 : (sweep - m_sweep) * m_buckets + (bucket - m_cursor);
+			if (steps < 0.0 || steps >= m_buckets) ClearAll();
+			else for (int b = m_cursor + 1, n = (int)steps; n > 0; --n, ++b) ClearBucket(b % m_buckets);
+			if (m_cursor != bucket || steps != 0.0) ys[2 * bucket] = ys[2 * bucket + 1] = y;
+			else {
+				ys[2 * bucket] = std::min(ys[2 * bucket], y);
+				ys[2 * bucket + 1] = std::max(ys[2 * bucket + 1], y);
+			}
+			m_cursor = bucket;
+			m_sweep = (int)sweep;
+		}
+
+		// The buckets are replayed oldest first into the new span at their start
+		// x, so the samples of the last min(old, new) span are kept and the
+		// cursor stays where it was in time. Setting the same span is free.
+		void SetSpan(float span) {
+			assert(span > 0.f && "Sweep span must be positive");
+			if (span == m_span) return;
+			const double oldSpan = m_span;
+			m_span = span;
+			if (!m_data) return;
+			InitX();
+			if (m_cursor < 0) return;
+			const int cursor = m_cursor, sweep = m_sweep;
+			const T* ys = m_data + 2 * m_buckets;
+			std::vector<T> old(ys, ys + 2 * m_buckets);
+			Erase();
+			for (int k = 1; k <= m_buckets; ++k) {
+				const int b = (cursor + k) % m_buckets;
+				if (std::isnan(old[2 * b])) continue;
+				// buckets past the cursor are left from the previous sweep
+				const double x = ((b > cursor ? sweep - 1 : sweep) + (double)b / m_buckets) * oldSpan;
+				AddPoint(x, old[2 * b]);
+				AddPoint(x, old[2 * b + 1]);
+			}
+		}
+		float GetSpan() const { return m_span; }
+		int BucketCount() const { return m_buckets; }
+
+		// Drops the samples and keeps the storage.
+		void Erase() { if (m_data) ClearAll(); m_cursor = -1; }
+		// Frees the storage; returns the bytes released.
+		size_t Release() {
+			const size_t bytes = m_data ? StorageBytes() : 0;
+			if (m_data) IM_FREE(m_data);
+			m_data = nullptr;
+			m_cursor = -1;
+			return bytes;
+		}
+
+		// 2 * BucketCount() points once a sample was added, 0 before.
+		int Size() const { return m_data ? 2 * m_buckets : 0; }
+		const T* X() const { return m_data; }
+		const T* Y() const { return m_data ? m_data + 2 * m_buckets : nullptr; }
+		// Points [0, CursorEnd()) belong to the current sweep, the rest to the
+		// previous one.
+		int CursorEnd() const { return m_cursor < 0 ? 0 : 2 * (m_cursor + 1); }
+
+	private:
+		size_t StorageBytes() const { return (size_t)m_buckets * 4 * sizeof(T); }
+		void Allocate() {
+			m_data = static_cast<T*>(IM_ALLOC(StorageBytes()));
+			InitX();
+			ClearAll();
+		}
+		void InitX() {
+			for (int b = 0; b < m_buckets; ++b) m_data[2 * b] = m_data[2 * b + 1] = (T)((double)m_span * b / m_buckets);
+		}
+		void ClearBucket(int b) { T* ys = m_data + 2 * m_buckets; ys[2 * b] = ys[2 * b + 1] = (T)NAN; }
+		void ClearAll() { for (int b = 0; b < m_buckets; ++b) ClearBucket(b); }
+		void Swap(SweepBuffer& other) noexcept {
+			std::swap(m_data, other.m_data);
+			std::swap(m_span, other.m_span);
+			std::swap(m_buckets, other.m_buckets);
+			std::swap(m_cursor, other.m_cursor);
+			std::swap(m_sweep, other.m_sweep);
+		}
+
+		T* m_data = nullptr;      // x column then y column, 2 * buckets each
+		float m_span;
+		int m_buckets;
+		int m_cursor = -1;        // bucket of the last sample, -1 when empty
+		int m_sweep = 0;          // floor(x / span) of the last sample
+	};
+
+	// Part of a PyramidChannel chosen for one plot: count points of one level,
+	// starting at first; level 0 is the raw samples, higher levels give two
+	// points (min, max) per bucket.
+	template <typename TX = double, typename TY = double>
+	class PyramidChannel;
+
+	template <typename TX, typename TY>
+	struct PyramidView {
+		const PyramidChannel<TX, TY>* Channel;
+		int Level;
+		int First;
+		int Count;
+	};
+
+	// Growing recording of (x, y) samples, x non-decreasing, with a min/max
+	// mip pyramid kept up to date as points are appended: a bucket of level L
+	// covers Fanout^L samples. Select() picks, for the visible x range and plot
+	// width, the coarsest level that still gives about two points per pixel
+	// column, so a plot of any zoom costs time proportional to its width
+	// rather than to the number of samples. The pyramid adds about half the
+	// memory of the raw samples.
+	template <typename TX, typename TY>
+	class PyramidChannel {
+	public:
+		static constexpr int Fanout = 4;
+		static_assert((Fanout & (Fanout - 1)) == 0, "Bucket starts are found with a mask");
+
+		struct Bucket {
+			TX X;       // x of the first sample in the bucket
+			TY Min;
+			TY Max;
+		};
+
+		void AddPoint(TX x, TY y) {
+			assert((m_x.empty() || x >= m_x.back()) && "Pyramid samples must be appended in x order");
+			const size_t i = m_x.size();
+			m_x.push_back(x);
+			m_y.push_back(y);
+			// every level's last bucket absorbs the sample, or a new bucket starts
+			// when i is a multiple of the level's span
+			size_t span = Fanout;
+			for (std::vector<Bucket>& buckets : m_levels) {
+				if ((i & (span - 1)) == 0) buckets.push_back({ x, y, y });
+				else { buckets.back().Min = std::min(buckets.back().Min, y); buckets.back().Max = std::max(buckets.back().Max, y); }
+				span *= Fanout;
+			}
+			// the top level never holds more than Fanout entries
+			const size_t top = m_levels.empty() ? m_x.size() : m_levels.back().size();
+			if (top > (size_t)Fanout) AddLevel();
+		}
+
+		void Clear() { m_x.clear(); m_y.clear(); m_levels.clear(); }
+		int Size() const { return (int)m_x.size(); }
+		int LevelCount() const { return 1 + (int)m_levels.size(); }
+		const TX* X() const { return m_x.data(); }
+		const TY* Y() const { return m_y.data(); }
+
+		// Level and sample range for [xMin, xMax] drawn over pixelWidth pixels,
+		// with one extra sample on each side so lines run off the plot edges.
+		PyramidView<TX, TY> Select(double xMin, double xMax, float pixelWidth) const {
+			PyramidView<TX, TY> view{ this, 0, 0, 0 };
+			if (m_x.empty()) return view;
+			size_t lo = std::lower_bound(m_x.begin(), m_x.end(), (TX)xMin) - m_x.begin();
+			size_t hi = std::upper_bound(m_x.begin(), m_x.end(), (TX)xMax) - m_x.begin();
+			lo = lo > 0 ? lo - 1 : 0;
+			hi = std::min(hi + 1, m_x.size());
+			const size_t budget = (size_t)std::max(pixelWidth, 1.f);
+			size_t span = 1;
+			while ((size_t)view.Level < m_levels.size() && (hi - lo) / span > budget) { ++view.Level; span *= Fanout; }
+			if (view.Level == 0) {
+				view.First = (int)lo;
+				view.Count = (int)(hi - lo);
+			}
+			else {
+				const size_t first = lo / span, last = (hi - 1) / span;
+				view.First = (int)(2 * first);
+				view.Count = (int)(2 * (last - first + 1));
+			}
+			return view;
+		}
+
+		// ImPlotGetter over a PyramidView.
+		static ImPlotPoint Getter(int idx, void* data) {
+			const PyramidView<TX, TY>& view = *static_cast<const PyramidView<TX, TY>*>(data);
+			const PyramidChannel& ch = *view.Channel;
+			const int i = view.First + idx;
+			if (view.Level == 0) return ImPlotPoint((double)ch.m_x[i], (double)ch.m_y[i]);
+			const Bucket& b = ch.m_levels[view.Level - 1][i / 2];
+			return ImPlotPoint((double)b.X, (double)((i & 1) ? b.Max : b.Min));
+		}
+
+	private:
+		void AddLevel() {
+			std::vector<Bucket> level;
+			const std::vector<Bucket>* below = m_levels.empty() ? nullptr : &m_levels.back();
+			const size_t n = below ? below->size() : m_x.size();
+			for (size_t k = 0; k < n; ++k) {
+				const Bucket b = below ? (*below)[k] : Bucket{ m_x[k], m_y[k], m_y[k] };
+				if (k % Fanout == 0) level.push_back(b);
+				else { level.back().Min = std::min(level.back().Min, b.Min); level.back().Max = std::max(level.back().Max, b.Max); }
+			}
+			m_levels.push_back(std::move(level));
+		}
+
+		std::vector<TX> m_x;
+		std::vector<TY> m_y;
+		std::vector<std::vector<Bucket>> m_levels;   // level L at index L - 1
+	};
+
+	// Plots the part of a PyramidChannel inside the current plot's x limits at
+	// the plot's pixel width. Call between BeginPlot/EndPlot; it ends the plot
+	// setup.
+	template <typename TX, typename TY>
+	void PlotPyramidLine(const char* label, const PyramidChannel<TX, TY>& channel, ImPlotLineFlags flags = 0) {
+		const ImPlotRect limits = ImPlot::GetPlotLimits();
+		PyramidView<TX, TY> view = channel.Select(limits.X.Min, limits.X.Max, ImPlot::GetPlotSize().x);
+		ImPlot::PlotLineG(label, &PyramidChannel<TX, TY>::Getter, &view, view.Count, flags);
+	}
+
+	// Plots a stream whose columns share a type; ImPlot reads the spans as is.
+	template <typename T>
+	void PlotStreamLine(const char* label, const StreamingBuffer<T, T>& buf, ImPlotLineFlags flags = 0) {
+		ImPlot::PlotLine(label, buf.X(), buf.Y(), buf.Size(), flags);
+	}
+
+	template <typename T>
+	void PlotStreamShaded(const char* label, const StreamingBuffer<T, T>& buf, double yRef = 0.0, ImPlotShadedFlags flags = 0) {
+		ImPlot::PlotShaded(label, buf.X(), buf.Y(), buf.Size(), yRef, flags);
+	}
+
+	// Buckets [First, First + Count) of a SweepBuffer merged GroupBuckets at a
+	// time into one (min, max) pair; groups without samples are NaN.
+	template <typename T>
+	struct SweepSeries {
+		const SweepBuffer<T>* Buffer;
+		int First;
+		int Count;
+		int GroupBuckets;
+		int CachedGroup = -1;
+		T CachedMin = 0;
+		T CachedMax = 0;
+
+		int PointCount() const { return 2 * ((Count + GroupBuckets - 1) / GroupBuckets); }
+
+		// even points are the group minimum, odd points its maximum
+		static ImPlotPoint Getter(int idx, void* data) {
+			SweepSeries& s = *static_cast<SweepSeries*>(data);
+			const int group = idx / 2;
+			const int first = s.First + group * s.GroupBuckets;
+			if (group != s.CachedGroup) {
+				s.CachedGroup = group;
+				s.CachedMin = s.CachedMax = (T)NAN;
+				const T* ys = s.Buffer->Y();
+				for (int b = first, end = std::min(first + s.GroupBuckets, s.First + s.Count); b < end; ++b) {
+					if (std::isnan(ys[2 * b])) continue;
+					s.CachedMin = std::isnan(s.CachedMin) ? ys[2 * b] : std::min(s.CachedMin, ys[2 * b]);
+					s.CachedMax = std::isnan(s.CachedMax) ? ys[2 * b + 1] : std::max(s.CachedMax, ys[2 * b + 1]);
+				}
+			}
+			return ImPlotPoint((double)s.Buffer->X()[2 * first], (double)((idx & 1) ? s.CachedMax : s.CachedMin));
+		}
+	};
+
+	// Two items under one label: the current sweep and the rest of the previous
+	// one, so the line breaks at the cursor but not at sparse buckets. Buckets
+	// are merged so there are at most 2 points per pixel column of the plot.
+	// Call between BeginPlot/EndPlot; it ends the plot setup.
+	template <typename T>
+	void PlotSweepLine(const char* label, const SweepBuffer<T>& buf, ImPlotLineFlags flags = 0) {
+		const int buckets = buf.Size() / 2;
+		const int split = buf.CursorEnd() / 2;
+		const int width = std::max(1, (int)ImPlot::GetPlotSize().x);
+		const int group = buckets > width ? (buckets + width - 1) / width : 1;
+		flags |= ImPlotLineFlags_SkipNaN;
+		SweepSeries<T> current{ &buf, 0, split, group };
+		SweepSeries<T> previous{ &buf, split, buckets - split, group };
+		ImPlot::PlotLineG(label, &SweepSeries<T>::Getter, &current, current.PointCount(), flags);
+		ImPlot::PlotLineG(label, &SweepSeries<T>::Getter, &previous, previous.PointCount(), flags);
+	}
+
+} // namespace FrameGUILayout
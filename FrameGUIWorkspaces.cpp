@@ -0,0 +1,73 @@
+#include "FrameGUIWorkspaces.h"
+
+namespace FrameGUILayout {
+
+	WorkspaceManager::~WorkspaceManager() {
+		for (Workspace& w : m_workspaces) delete w.layout;
+	}
+
+	int WorkspaceManager::Add(const char* name, CustomLayout* layout) {
+		assert(layout != nullptr && "Workspace layout must not be null");
+		m_workspaces.push_back({ name ? name : "Workspace", layout, 0.0, false });
+		layout->SetControlPanelCallback(&WorkspaceManager::DrawSelector, this);
+		if (m_active < 0) m_active = 0;
+		return (int)m_workspaces.size() - 1;
+	}
+
+	void WorkspaceManager::SetActive(int index) {
+		assert(index >= 0 && index < (int)m_workspaces.size() && "Workspace index out of range");
+		if (index == m_active) return;
+		// the outgoing workspace starts its idle period now
+		if (m_active >= 0 && ImGui::GetCurrentContext())
+			m_workspaces[m_active].lastActiveTime = ImGui::GetTime();
+		m_active = index;
+		m_workspaces[index].released = false;
+	}
+
+	int WorkspaceManager::GetActive() const { return m_active; }
+	int WorkspaceManager::Count() const { return (int)m_workspaces.size(); }
+	CustomLayout* WorkspaceManager::GetLayout(int index) const { return m_workspaces[index].layout; }
+	const std::string& WorkspaceManager::GetName(int index) const { return m_workspaces[index].name; }
+
+	void WorkspaceManager::SetIdleReleaseDelay(float seconds) { m_idleReleaseDelay = seconds; }
+
+	void WorkspaceManager::UpdateAndRender() {
+		if (m_active < 0) return;
+		const double now = ImGui::GetTime();
+		Workspace& active = m_workspaces[m_active];
+		active.layout->UpdateAndRender();
+		active.lastActiveTime = now;
+		ReleaseIdle(now);
+	}
+
+	void WorkspaceManager::ReleaseIdle(double now) {
+		if (m_idleReleaseDelay < 0.f) return;
+		for (int i = 0; i < (int)m_workspaces.size(); ++i) {
+			Workspace& w = m_workspaces[i];
+			if (i == m_active || w.released || now - w.lastActiveTime < m_idleReleaseDelay) continue;
+			w.layout->ReleaseTransientBuffers();
+			w.released = true;
+		}
+	}
+
+	// Drawn by the active layout at the end of its control panel.
+	void WorkspaceManager::DrawSelector(void* userData) {
+		static_cast<WorkspaceManager*>(userData)->DrawSelector();
+	}
+
+	void WorkspaceManager::DrawSelector() {
+		if (m_workspaces.size() < 2) return;
+		ImGui::Separator();
+		if (ImGui::BeginCombo("Workspace", m_workspaces[m_active].name.c_str())) {
+			int selected = m_active;
+			for (int i = 0; i < (int)m_workspaces.size(); ++i) {
+				ImGui::PushID(i);
+				if (ImGui::Selectable(m_workspaces[i].name.c_str(), i == m_active)) selected = i;
+				ImGui::PopID();
+			}
+			ImGui::EndCombo();
+			if (selected != m_active) SetActive(selected);
+		}
+	}
+
+} // namespace FrameGUILayout
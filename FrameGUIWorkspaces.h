@@ -0,0 +1,53 @@
+#pragma once
+
+#include "FrameGUILayout.h"
+
+namespace FrameGUILayout {
+
+	// Owns several CustomLayouts and renders one of them at a time. Inactive
+	// layouts keep their geometry, splitter index and pane state, so switching
+	// is an index change: the next frame neither relayouts nor re-equalises
+	// unless the viewport changed in the meantime. Layouts that stay inactive
+	// for longer than the idle delay release their transient buffers.
+	class WorkspaceManager {
+	public:
+		WorkspaceManager() = default;
+		~WorkspaceManager();
+		WorkspaceManager(const WorkspaceManager&) = delete;
+		WorkspaceManager& operator=(const WorkspaceManager&) = delete;
+
+		// Takes ownership of the layout. The first workspace added becomes active.
+		int Add(const char* name, CustomLayout* layout);
+
+		void SetActive(int index);
+		int GetActive() const;
+		int Count() const;
+		CustomLayout* GetLayout(int index) const;
+		const std::string& GetName(int index) const;
+
+		// Seconds a workspace must stay inactive before its transient buffers are
+		// released; negative disables the release.
+		void SetIdleReleaseDelay(float seconds);
+
+		// Renders the active workspace and adds a workspace selector to its
+		// Layout Control panel.
+		void UpdateAndRender();
+
+	private:
+		struct Workspace {
+			std::string name;
+			CustomLayout* layout;
+			double lastActiveTime;
+			bool released;
+		};
+
+		void ReleaseIdle(double now);
+		static void DrawSelector(void* userData);
+		void DrawSelector();
+
+		std::vector<Workspace> m_workspaces;
+		int m_active = -1;
+		float m_idleReleaseDelay = 30.f;
+	};
+
+} // namespace FrameGUILayout
@@ -0,0 +1,100 @@
+// Compares the pointer-based CustomLayoutNode tree against FlatLayoutTree on
+// large synthetic layouts. Runs headless: an ImGui context without renderer.
+#include "FrameGUILayout.h"
+#include "FrameGUIFlatLayout.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace FrameGUILayout;
+
+static void EmptyPane() {}
+
+// depth levels of fanOut children, alternating split direction
+static CustomLayoutNode* BuildNodeTree(int depth, int fanOut, bool vertical) {
+	if (depth == 0) return new CustomLayoutNode(&EmptyPane, "Pane");
+	auto* node = new CustomLayoutNode(vertical, vertical ? "V" : "H");
+	for (int i = 0; i < fanOut; ++i) {
+		CustomLayoutNode* child = BuildNodeTree(depth - 1, fanOut, !vertical);
+		if (vertical) node->AddVerticalChild(child); else node->AddHorizontalChild(child);
+	}
+	return node;
+}
+
+// uneven weights, so a conversion that re-equalises shows up in the check
+static void SkewRatios(CustomLayoutNode* node) {
+	const auto& children = node->GetChildren();
+	for (int i = 0; i < (int)children.size(); ++i) {
+		node->SetSplitRatio(i, 1.f + (float)i);
+		SkewRatios(children[i]);
+	}
+}
+
+// Flat nodes are appended in preorder; counts the nodes whose rect differs.
+static int CountMismatches(const CustomLayoutNode* node, const FlatLayoutTree& flat, int& index) {
+	const int i = index++;
+	const ImVec2 pos = node->GetDomainPos(), size = node->GetDomainSize();
+	const ImVec2 flatPos = flat.GetDomainPos(i), flatSize = flat.GetDomainSize(i);
+	int bad = ImFabs(pos.x - flatPos.x) > 1e-3f || ImFabs(pos.y - flatPos.y) > 1e-3f ||
+		ImFabs(size.x - flatSize.x) > 1e-3f || ImFabs(size.y - flatSize.y) > 1e-3f;
+	for (const CustomLayoutNode* c : node->GetChildren()) bad += CountMismatches(c, flat, index);
+	return bad;
+}
+
+template <typename F>
+static double MeasureNsPerIter(int iterations, F&& f) {
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) f(i);
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+	const int iterations = argc > 1 ? atoi(argv[1]) : 200;
+
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920, 1080);
+	io.DeltaTime = 1.f / 60.f;
+	unsigned char* pixels; int w, h;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+	ImGui::NewFrame();
+
+	int failures = 0;
+	struct Shape { int depth, fanOut; } shapes[] = { { 4, 10 }, { 7, 4 }, { 14, 2 }, { 3, 32 } };
+	printf("%-8s %-8s %-8s %14s %14s %8s\n", "depth", "fanout", "panes", "node ns/iter", "flat ns/iter", "speedup");
+	for (const Shape& s : shapes) {
+		CustomLayoutNode* root = BuildNodeTree(s.depth, s.fanOut, false);
+		int panes = 1;
+		for (int d = 0; d < s.depth; ++d) panes *= s.fanOut;
+
+		// convert a tree that has been laid out and dragged; both must agree
+		root->ResizeNodeAndChildren(ImVec2(0, 0), io.DisplaySize);
+		SkewRatios(root);
+		root->ResizeNodeAndChildren(ImVec2(0, 0), io.DisplaySize);
+		FlatLayoutTree flat(root);
+		flat.Layout(ImVec2(0, 0), io.DisplaySize);
+		int index = 0;
+		if (int bad = CountMismatches(root, flat, index)) {
+			fprintf(stderr, "depth %d fanout %d: %d converted rects differ from the source tree\n", s.depth, s.fanOut, bad);
+			failures++;
+		}
+
+		// jitter the viewport so neither backend can short-circuit on an unchanged size
+		double nodeNs = MeasureNsPerIter(iterations, [&](int i) {
+			root->ResizeNodeAndChildren(ImVec2(0, 0), ImVec2(io.DisplaySize.x - 1 - (i & 7), io.DisplaySize.y));
+			root->RenderPanes();
+		});
+		double flatNs = MeasureNsPerIter(iterations, [&](int i) {
+			flat.Layout(ImVec2(0, 0), ImVec2(io.DisplaySize.x - 1 - (i & 7), io.DisplaySize.y));
+			flat.RenderPanes();
+		});
+		printf("%-8d %-8d %-8d %14.0f %14.0f %7.2fx\n", s.depth, s.fanOut, panes, nodeNs, flatNs, nodeNs / flatNs);
+		delete root;
+	}
+
+	ImGui::EndFrame();
+	ImGui::DestroyContext();
+	return failures == 0 ? 0 : 1;
+}
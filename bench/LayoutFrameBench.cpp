@@ -0,0 +1,309 @@
+// Runs whole CustomLayout::UpdateAndRender frames against a headless ImGui
+// context (no renderer) on synthetic trees, with optional visibility churn
+// and a simulated splitter drag. Prints one JSON object per scenario:
+//
+//   LayoutFrameBench [--depth N --fanout N] [--churn N] [--drag [--drag-depth N]]
+//                    [--backend node|flat] [--frames N] [--pane-windows]
+//                    [--prepare-us N] [--workers N] [--grid] [--scroll]
+//
+// --prepare-us makes every pane two-phase with a Prepare that busy-waits for
+// N microseconds; --workers N runs Prepare on a pool of N threads (0 = one
+// per hardware thread), otherwise it runs on the calling thread.
+//
+// --drag-depth N drags the first boundary of the splitter N levels below the
+// root (following first children) instead of the root's.
+//
+// --grid replaces every two-level split (fanout x fanout panes) with one
+// fanout x fanout grid node; node backend only.
+//
+// --scroll turns every split of panes into a scroll container of 100px
+// panes; with --depth 1 the root is scrolled by 7px every frame. Node
+// backend only.
+//
+// Without --depth/--fanout a fixed matrix of shapes and scenarios is run.
+#include "FrameGUILayout.h"
+#include "FrameGUIFlatLayout.h"
+#include "FrameGUIPaneWorkers.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+using namespace FrameGUILayout;
+
+// every heap allocation, from operator new and from ImGui's allocator
+static long long g_allocCount = 0;
+
+void* operator new(size_t size) {
+	++g_allocCount;
+	if (void* p = malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+static void* CountingAlloc(size_t size, void*) { ++g_allocCount; return malloc(size); }
+static void CountingFree(void* p, void*) { free(p); }
+
+static void EmptyPane() {}
+
+struct WindowPane {
+	char Name[16];
+	void operator()() const { ImGui::Begin(Name); ImGui::End(); }
+};
+
+// stands in for per-pane data work that needs no ImGui calls
+struct PreparedPane {
+	float PrepareUs;
+	double Sink = 0.0;
+	void Prepare(float, const ImRect& rect) {
+		const auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds((long long)(PrepareUs * 1000.f));
+		while (std::chrono::steady_clock::now() < end) Sink += rect.GetWidth() * 1e-9;
+	}
+	void operator()() const {}
+};
+
+struct Options {
+	int depth = 0;
+	int fanOut = 0;
+	int churn = 0;          // panes whose visibility is toggled every frame
+	bool drag = false;
+	int dragDepth = 0;
+	bool flat = false;
+	bool paneWindows = false;
+	int frames = 300;
+	float prepareUs = 0.f;
+	int workers = -1;       // < 0: Prepare runs on the calling thread
+	bool grid = false;
+	bool scroll = false;
+};
+
+static int g_paneSerial = 0;
+
+static CustomLayoutNode* BuildTree(int depth, int fanOut, bool vertical, const Options& opt, std::vector<CustomLayoutNode*>& panes) {
+	if (depth == 2 && opt.grid) {
+		auto* grid = new CustomLayoutNode(LayoutNode_Grid, "G");
+		grid->SetGridSize(fanOut, fanOut);
+		for (int r = 0; r < fanOut; ++r)
+			for (int c = 0; c < fanOut; ++c) grid->AddGridCell(BuildTree(0, fanOut, vertical, opt, panes), c, r);
+		return grid;
+	}
+	if (depth == 0) {
+		CustomLayoutNode* pane;
+		if (opt.prepareUs > 0.f) pane = new CustomLayoutNode(PreparedPane{ opt.prepareUs }, "Pane");
+		else if (opt.paneWindows) {
+			WindowPane w;
+			snprintf(w.Name, sizeof(w.Name), "P%d", g_paneSerial++);
+			pane = new CustomLayoutNode(w, w.Name);
+		}
+		else pane = new CustomLayoutNode(&EmptyPane, "Pane");
+		panes.push_back(pane);
+		return pane;
+	}
+	if (depth == 1 && opt.scroll) {
+		auto* scroll = new CustomLayoutNode(LayoutNode_Scroll, "S");
+		scroll->SetScrollItemExtent(100.f);
+		for (int i = 0; i < fanOut; ++i) scroll->AddScrollChild(BuildTree(0, fanOut, vertical, opt, panes));
+		return scroll;
+	}
+	auto* node = new CustomLayoutNode(vertical, vertical ? "V" : "H");
+	for (int i = 0; i < fanOut; ++i) {
+		CustomLayoutNode* child = BuildTree(depth - 1, fanOut, !vertical, opt, panes);
+		if (vertical) node->AddVerticalChild(child); else node->AddHorizontalChild(child);
+	}
+	return node;
+}
+
+static void CountNodes(const CustomLayoutNode* node, int& count) {
+	++count;
+	for (const CustomLayoutNode* c : node->GetChildren()) CountNodes(c, count);
+}
+
+static void CollectFlatPanes(const FlatLayoutTree& tree, std::vector<int>& out) {
+	for (int i = 0; i < tree.NodeCount(); ++i) if (tree.IsWindowNode(i)) out.push_back(i);
+}
+
+static unsigned int NextRandom(unsigned int& state) {
+	state = state * 1664525u + 1013904223u;
+	return state >> 8;
+}
+
+static void NewFrame(float mouseX, float mouseY, bool mouseDown) {
+	ImGuiIO& io = ImGui::GetIO();
+	io.AddMousePosEvent(mouseX, mouseY);
+	io.AddMouseButtonEvent(ImGuiMouseButton_Left, mouseDown);
+	ImGui::NewFrame();
+}
+
+static void RunScenario(const Options& opt) {
+	g_paneSerial = 0;
+
+	std::vector<CustomLayoutNode*> panes;
+	CustomLayoutNode* root = BuildTree(opt.depth, opt.fanOut, false, opt, panes);
+	int nodeCount = 0;
+	CountNodes(root, nodeCount);
+
+	FlatLayoutTree* flat = nullptr;
+	std::vector<int> flatPanes;
+	if (opt.flat) {
+		flat = new FlatLayoutTree(root);
+		CollectFlatPanes(*flat, flatPanes);
+	}
+	CustomLayout* layout = opt.flat ? new CustomLayout(flat) : new CustomLayout(root);
+	const int paneCount = (int)panes.size();
+	if (opt.workers >= 0) layout->EnableParallelPrepare(true, opt.workers);
+	const int workers = opt.workers < 0 ? 0 : opt.workers > 0 ? opt.workers : PaneWorkerPool::DefaultWorkerCount();
+
+	// first frame lays the tree out and lets the boundary under the drag be found
+	NewFrame(-1.f, -1.f, false);
+	layout->UpdateAndRender();
+	ImGui::Render();
+	// the boundary after the first child of the dragged splitter, at the
+	// middle of its span
+	ImVec2 dragPos, dragSize, childPos, childSize;
+	bool dragVertical;
+	if (opt.flat) {
+		int node = 0;
+		for (int d = 0; d < opt.dragDepth && !flat->IsWindowNode(flat->GetFirstChild(node)); ++d) node = flat->GetFirstChild(node);
+		dragPos = flat->GetDomainPos(node); dragSize = flat->GetDomainSize(node);
+		childPos = flat->GetDomainPos(flat->GetFirstChild(node)); childSize = flat->GetDomainSize(flat->GetFirstChild(node));
+		dragVertical = flat->IsVerticalSplitter(node);
+	}
+	else {
+		const CustomLayoutNode* node = root;
+		for (int d = 0; d < opt.dragDepth && !node->GetChildren()[0]->IsWindowNode(); ++d) node = node->GetChildren()[0];
+		dragPos = node->GetDomainPos(); dragSize = node->GetDomainSize();
+		childPos = node->GetChildren()[0]->GetDomainPos(); childSize = node->GetChildren()[0]->GetDomainSize();
+		dragVertical = node->IsVerticalSplitter();
+	}
+	const ImVec2 boundary = dragVertical
+		? ImVec2(dragPos.x + dragSize.x * 0.5f, childPos.y + childSize.y)
+		: ImVec2(childPos.x + childSize.x, dragPos.y + dragSize.y * 0.5f);
+	if (opt.drag) {
+		NewFrame(boundary.x, boundary.y, false);
+		layout->UpdateAndRender();
+		ImGui::Render();
+	}
+
+	// warm-up so lazily grown buffers reach their steady-state capacity
+	unsigned int rng = 12345u;
+	auto step = [&](int frame) {
+		for (int c = 0; c < opt.churn; ++c) {
+			const int pick = (int)(NextRandom(rng) % (unsigned int)paneCount);
+			if (opt.flat) flat->SetVisible(flatPanes[pick], !flat->IsVisibleFlag(flatPanes[pick]));
+			else panes[pick]->SetVisible(!panes[pick]->IsVisibleFlag());
+		}
+		if (opt.drag) {
+			// triangle wave of +-30px starting on the boundary, 2px per frame, with
+			// the mouse held for the whole run
+			const float offset = (float)(abs((frame + 15) % 60 - 30) - 15) * 2.f;
+			if (dragVertical) NewFrame(boundary.x, boundary.y + offset, true);
+			else NewFrame(boundary.x + offset, boundary.y, true);
+		}
+		else NewFrame(-1.f, -1.f, false);
+		if (root->IsScrollContainer()) root->SetScrollPos((float)(frame * 7 % 3000));
+	};
+	for (int f = 0; f < 60; ++f) { step(f); layout->UpdateAndRender(); ImGui::Render(); }
+
+	std::vector<double> frameNs(opt.frames);
+	double layoutNsTotal = 0.0;
+	const int relayoutsBefore = layout->GetRelayoutCount();
+	const long long allocsBefore = g_allocCount;
+	for (int f = 0; f < opt.frames; ++f) {
+		auto t0 = std::chrono::steady_clock::now();
+		step(60 + f);
+		auto t1 = std::chrono::steady_clock::now();
+		layout->UpdateAndRender();
+		auto t2 = std::chrono::steady_clock::now();
+		ImGui::Render();
+		auto t3 = std::chrono::steady_clock::now();
+		frameNs[f] = std::chrono::duration<double, std::nano>(t3 - t0).count();
+		layoutNsTotal += std::chrono::duration<double, std::nano>(t2 - t1).count();
+	}
+	const long long allocs = g_allocCount - allocsBefore;
+	const int relayouts = layout->GetRelayoutCount() - relayoutsBefore;
+
+	double frameNsTotal = 0.0;
+	for (double ns : frameNs) frameNsTotal += ns;
+	std::sort(frameNs.begin(), frameNs.end());
+	const double p99 = frameNs[std::min(opt.frames - 1, (int)std::ceil(0.99 * opt.frames) - 1)];
+	const double nsPerFrame = frameNsTotal / opt.frames;
+	const double layoutNsPerFrame = layoutNsTotal / opt.frames;
+
+	printf("{\"bench\":\"LayoutFrameBench\",\"backend\":\"%s\",\"depth\":%d,\"fanout\":%d,\"nodes\":%d,\"panes\":%d,"
+		"\"grid\":%s,\"scroll\":%s,\"churn\":%d,\"drag\":%s,\"drag_depth\":%d,\"pane_windows\":%s,\"prepare_us\":%.0f,\"workers\":%d,\"frames\":%d,\"relayouts\":%d,"
+		"\"ns_per_frame\":%.0f,\"p99_ns_per_frame\":%.0f,\"layout_ns_per_frame\":%.0f,"
+		"\"allocs_per_frame\":%.3f,\"nodes_per_sec\":%.0f}\n",
+		opt.flat ? "flat" : "node", opt.depth, opt.fanOut, nodeCount, paneCount,
+		opt.grid ? "true" : "false", opt.scroll ? "true" : "false", opt.churn, opt.drag ? "true" : "false", opt.dragDepth, opt.paneWindows ? "true" : "false", opt.prepareUs, workers, opt.frames, relayouts,
+		nsPerFrame, p99, layoutNsPerFrame,
+		(double)allocs / opt.frames, nodeCount * 1e9 / layoutNsPerFrame);
+	fflush(stdout);
+
+	// release the drag before the next scenario
+	NewFrame(-1.f, -1.f, false);
+	ImGui::Render();
+
+	// the layout owns the tree it drives; the node tree a flat tree was
+	// converted from is still ours
+	delete layout;
+	if (opt.flat) delete root;
+}
+
+int main(int argc, char** argv) {
+	Options base;
+	for (int i = 1; i < argc; ++i) {
+		const char* a = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (!strcmp(a, "--depth") && hasValue) base.depth = atoi(argv[++i]);
+		else if (!strcmp(a, "--fanout") && hasValue) base.fanOut = atoi(argv[++i]);
+		else if (!strcmp(a, "--churn") && hasValue) base.churn = atoi(argv[++i]);
+		else if (!strcmp(a, "--frames") && hasValue) base.frames = atoi(argv[++i]);
+		else if (!strcmp(a, "--prepare-us") && hasValue) base.prepareUs = (float)atof(argv[++i]);
+		else if (!strcmp(a, "--workers") && hasValue) base.workers = atoi(argv[++i]);
+		else if (!strcmp(a, "--backend") && hasValue) base.flat = !strcmp(argv[++i], "flat");
+		else if (!strcmp(a, "--drag")) base.drag = true;
+		else if (!strcmp(a, "--drag-depth") && hasValue) base.dragDepth = atoi(argv[++i]);
+		else if (!strcmp(a, "--pane-windows")) base.paneWindows = true;
+		else if (!strcmp(a, "--grid")) base.grid = true;
+		else if (!strcmp(a, "--scroll")) base.scroll = true;
+		else { fprintf(stderr, "unknown argument: %s\n", a); return 1; }
+	}
+	if (base.frames < 1) base.frames = 1;
+	if ((base.grid || base.scroll) && base.flat) { fprintf(stderr, "--grid and --scroll need the node backend\n"); return 1; }
+
+	ImGui::SetAllocatorFunctions(&CountingAlloc, &CountingFree);
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920, 1080);
+	io.DeltaTime = 1.f / 60.f;
+	unsigned char* pixels; int w, h;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+
+	if (base.depth > 0 && base.fanOut > 0) {
+		RunScenario(base);
+	}
+	else {
+		struct Shape { int depth, fanOut; } shapes[] = { { 2, 4 }, { 4, 10 }, { 7, 4 }, { 3, 32 } };
+		for (const Shape& s : shapes) {
+			for (int backend = 0; backend < 2; ++backend) {
+				Options opt = base;
+				opt.depth = s.depth; opt.fanOut = s.fanOut; opt.flat = backend == 1;
+				opt.churn = 0; opt.drag = false;
+				RunScenario(opt);
+				opt.churn = 4;
+				RunScenario(opt);
+				opt.churn = 0; opt.drag = true;
+				RunScenario(opt);
+			}
+		}
+	}
+
+	ImGui::DestroyContext();
+	return 0;
+}
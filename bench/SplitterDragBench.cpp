@@ -0,0 +1,86 @@
+// Drags one boundary back and forth inside a wide N-ary strip and hit-tests
+// random points along it. Runs headless: an ImGui context without renderer.
+#include "FrameGUILayout.h"
+#include "FrameGUIFlatLayout.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace FrameGUILayout;
+
+static void EmptyPane() {}
+
+template <typename F>
+static double MeasureNsPerIter(int iterations, F&& f) {
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) f(i);
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+	const int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+	const int childCount = argc > 2 ? atoi(argv[2]) : 256;
+
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(8192, 1080);
+	io.DeltaTime = 1.f / 60.f;
+	unsigned char* pixels; int w, h;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+	ImGui::NewFrame();
+
+	std::vector<CustomLayoutNode*> panes;
+	for (int i = 0; i < childCount; ++i) panes.push_back(new CustomLayoutNode(&EmptyPane, "Pane"));
+	auto* strip = new CustomLayoutNode(false, "Strip");
+	strip->SetHorizontalChildren(panes.data(), (int)panes.size());
+	FlatLayoutTree flat(strip);
+
+	strip->ResizeNodeAndChildren(ImVec2(0, 0), io.DisplaySize);
+	flat.Layout(ImVec2(0, 0), io.DisplaySize);
+
+	// a middle boundary, moved +-1px so the strip never drifts into the clamp
+	const int boundary = childCount / 2;
+	const int flatRoot = 0;
+	auto delta = [](int i) { return ImVec2((i & 1) ? -1.f : 1.f, 0.f); };
+
+	double nodeDragNs = MeasureNsPerIter(iterations, [&](int i) {
+		strip->HandleSplitterDragAt(boundary, delta(i));
+	});
+	double flatDragNs = MeasureNsPerIter(iterations, [&](int i) {
+		flat.HandleSplitterDragAt(flatRoot, boundary, delta(i));
+	});
+	double nodeFrameNs = MeasureNsPerIter(iterations, [&](int i) {
+		strip->HandleSplitterDragAt(boundary, delta(i));
+		strip->ResizeNodeAndChildren(ImVec2(0, 0), io.DisplaySize);
+	});
+	double flatFrameNs = MeasureNsPerIter(iterations, [&](int i) {
+		flat.HandleSplitterDragAt(flatRoot, boundary, delta(i));
+		flat.Layout(ImVec2(0, 0), io.DisplaySize);
+	});
+
+	int hits = 0;
+	double nodeHitNs = MeasureNsPerIter(iterations, [&](int i) {
+		CustomLayoutNode* node; int index;
+		ImVec2 mouse((float)((i * 7919) % (int)io.DisplaySize.x), 540.f);
+		hits += strip->FindHoveredSplitter(mouse, node, index);
+	});
+	double flatHitNs = MeasureNsPerIter(iterations, [&](int i) {
+		int node, index;
+		ImVec2 mouse((float)((i * 7919) % (int)io.DisplaySize.x), 540.f);
+		hits += flat.FindHoveredSplitter(mouse, node, index);
+	});
+
+	printf("%d children, %d iterations (%d hover hits)\n", childCount, iterations, hits);
+	printf("%-22s %14s %14s\n", "", "node ns/iter", "flat ns/iter");
+	printf("%-22s %14.1f %14.1f\n", "drag", nodeDragNs, flatDragNs);
+	printf("%-22s %14.1f %14.1f\n", "drag + relayout", nodeFrameNs, flatFrameNs);
+	printf("%-22s %14.1f %14.1f\n", "hover hit-test", nodeHitNs, flatHitNs);
+
+	delete strip;
+	ImGui::EndFrame();
+	ImGui::DestroyContext();
+	return 0;
+}
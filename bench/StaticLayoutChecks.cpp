@@ -0,0 +1,46 @@
+// Compiled into FrameGUILayoutBenchCore so the compile-time layout DSL is
+// instantiated on every platform, not only by the Windows demo: the checks
+// below and the static_asserts inside FrameGUIStaticLayout.h fail the build
+// if a description stops compiling or numbers its nodes differently.
+#include "FrameGUIStaticLayout.h"
+
+namespace {
+
+	void PaneA() {}
+	void PaneB() {}
+	void PaneC() {}
+	void PaneD() {}
+
+	constexpr char LabelA[] = "A";
+
+	using namespace FrameGUILayout;
+	using Nested = HSplit<VSplit<Pane<&PaneA, LabelA>, Pane<&PaneB>>, Pane<&PaneC>, VSplit<Pane<&PaneD>>>;
+
+	static_assert(Nested::NodeCount == 7, "Two splits, one nested split with one pane, four panes");
+	static_assert(Nested::PaneCount == 4, "Every Pane counts once");
+	static_assert(Nested::MaxChildCount == 3, "The root is the widest split");
+	static_assert(StaticLayout<Nested>::NodeCount == Nested::NodeCount, "StaticLayout sizes its arrays from the description");
+	static_assert(StaticLayoutDetail::IsLayoutNode<Pane<&PaneA>>::value && !StaticLayoutDetail::IsLayoutNode<int>::value,
+		"Only Pane, HSplit and VSplit are layout nodes");
+
+	constexpr StaticLayoutDetail::Topology<Nested::NodeCount> NestedTopology = [] {
+		StaticLayoutDetail::Topology<Nested::NodeCount> t{};
+		Nested::Fill(t, 0, -1);
+		return t;
+	}();
+
+	// preorder: 0 root, 1 VSplit, 2 A, 3 B, 4 C, 5 VSplit, 6 D
+	static_assert(NestedTopology.parent[0] == -1 && NestedTopology.parent[2] == 1 && NestedTopology.parent[4] == 0 && NestedTopology.parent[6] == 5,
+		"Children are numbered after their parent");
+	static_assert(NestedTopology.firstChild[0] == 1 && NestedTopology.nextSibling[1] == 4 && NestedTopology.nextSibling[4] == 5 && NestedTopology.nextSibling[5] == -1,
+		"Siblings skip over the subtree of the previous child");
+	static_assert(NestedTopology.kind[1] == StaticLayoutDetail::NodeKind_Vertical && NestedTopology.kind[6] == StaticLayoutDetail::NodeKind_Window,
+		"Node kinds follow the description");
+	static_assert(NestedTopology.label[2] == LabelA && NestedTopology.label[3] == StaticLayoutDetail::DefaultPaneLabel,
+		"Panes without a label use the default one");
+
+} // namespace
+
+// every member, including the drag and render paths
+template class FrameGUILayout::StaticLayout<Nested>;
+template FrameGUILayout::CustomLayoutNode* FrameGUILayout::BuildNodeTree<Nested>();
@@ -0,0 +1,273 @@
+// Compares the realtime plot buffers in headless frames (no renderer):
+//  - the interleaved float ScrollingBuffer with StreamingBuffer<double> on a
+//    long-running stream: ingest cost, ImPlot line cost and timestamp
+//    precision after the given number of hours at 60 samples per second;
+//  - RollingBuffer with SweepBuffer on a fast signal with one single-sample
+//    spike per sweep: points plotted, memory, line cost and whether the spike
+//    is still in the plotted data;
+//  - SampleQueue between a paced acquisition thread and a 60 Hz consumer
+//    that drains into a StreamingBuffer (drops, high-water mark, drain cost),
+//    and the per-sample cost of push and drain on one thread, which does not
+//    depend on how the two threads are scheduled;
+//  - a long recording plotted raw against PyramidChannel at several zoom
+//    levels: points handed to ImPlot and ns/frame.
+// Prints one JSON object per comparison:
+//
+//   StreamBufferBench [--points N] [--frames N] [--hours H]
+//                     [--rate HZ] [--span S] [--buckets N]
+//                     [--ingest-hz HZ] [--queue N] [--recording N]
+#include "FrameGUILayout.h"
+#include "FrameGUIStreamBuffers.h"
+#include "FrameGUISampleQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace FrameGUILayout;
+
+template <typename F>
+static double MeasureNsPerIter(int iterations, F&& f) {
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) f(i);
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+// one plot window with one line, like a realtime pane; auto-fit unless an
+// x range is given
+template <typename F>
+static double MeasurePlotFrameNs(int frames, F&& plot, double xMin = 0.0, double xMax = 0.0) {
+	return MeasureNsPerIter(frames, [&](int) {
+		ImGui::NewFrame();
+		ImGui::SetNextWindowPos(ImVec2(0, 0));
+		ImGui::SetNextWindowSize(ImVec2(1600, 900));
+		ImGui::Begin("Plot");
+		if (ImPlot::BeginPlot("##Stream", ImVec2(-1, -1))) {
+			const bool fixed = xMax > xMin;
+			ImPlot::SetupAxes(nullptr, nullptr, fixed ? 0 : ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+			if (fixed) ImPlot::SetupAxisLimits(ImAxis_X1, xMin, xMax, ImGuiCond_Always);
+			plot();
+			ImPlot::EndPlot();
+		}
+		ImGui::End();
+		ImGui::Render();
+	});
+}
+
+static void RunScrolling(int points, int frames, double hours) {
+	// start the stream `hours` in, accumulating time the way a pane does
+	const long long startSample = (long long)(hours * 3600.0 * 60.0);
+	const long long total = startSample + points * 3LL;
+	ScrollingBuffer legacy(points);
+	StreamingBuffer<double> stream(points);
+	float tf = 0.f;
+	double td = 0.0;
+	const float dtf = 1.f / 60.f;
+	const double dtd = 1.0 / 60.0;
+	for (long long i = 0; i < total; ++i) {
+		tf += dtf;
+		td += dtd;
+		if (i < startSample) continue;
+		const float y = sinf((float)i * 0.01f);
+		legacy.AddPoint(tf, y);
+		stream.AddPoint(td, y);
+	}
+
+	// worst error of the stored timestamps against the exact sample times
+	double legacyErr = 0.0, streamErr = 0.0;
+	for (int k = 0; k < points; ++k) {
+		const long long sample = total - points + k;
+		const double exact = (double)(sample + 1) / 60.0;
+		const ImVec2& p = legacy.Data[(legacy.Offset + k) % points];
+		legacyErr = fmax(legacyErr, fabs((double)p.x - exact));
+		streamErr = fmax(streamErr, fabs(stream.X()[k] - exact));
+	}
+
+	const int adds = 1 << 22;
+	const double legacyAddNs = MeasureNsPerIter(adds, [&](int i) { legacy.AddPoint((float)i, (float)i); });
+	const double streamAddNs = MeasureNsPerIter(adds, [&](int i) { stream.AddPoint((double)i, (double)i); });
+
+	const double legacyPlotNs = MeasurePlotFrameNs(frames, [&] {
+		ImPlot::PlotLine("legacy", &legacy.Data[0].x, &legacy.Data[0].y, legacy.Data.size(), 0, legacy.Offset, 2 * sizeof(float));
+	});
+	const double streamPlotNs = MeasurePlotFrameNs(frames, [&] {
+		PlotStreamLine("stream", stream);
+	});
+
+	printf("{\"buffer\":\"scrolling\",\"points\":%d,\"hours\":%.1f,"
+		"\"legacy\":{\"add_ns\":%.2f,\"plot_ns_per_frame\":%.0f,\"max_time_error_s\":%.6f},"
+		"\"stream\":{\"add_ns\":%.2f,\"plot_ns_per_frame\":%.0f,\"max_time_error_s\":%.9f}}\n",
+		points, hours,
+		legacyAddNs, legacyPlotNs, legacyErr,
+		streamAddNs, streamPlotNs, streamErr);
+}
+
+static void RunRolling(double rateHz, float span, int buckets, int frames) {
+	RollingBuffer legacy;
+	legacy.Span = span;
+	SweepBuffer<float> sweep(span, buckets);
+	const long long perSweep = (long long)(rateHz * span);
+	const long long spikeAt = perSweep / 3;
+	size_t legacyPeak = 0;
+	// two sweeps, stopping just before the second one ends
+	for (long long i = 0; i < 2 * perSweep - 1; ++i) {
+		const double t = (double)i / rateHz;
+		const float y = (i % perSweep) == spikeAt ? 10.f : 0.5f + 0.1f * sinf((float)t * 50.f);
+		legacy.AddPoint((float)t, y);
+		sweep.AddPoint(t, y);
+		legacyPeak = ImMax(legacyPeak, (size_t)legacy.Data.Capacity * sizeof(ImVec2));
+	}
+
+	float legacyMax = 0.f, sweepMax = 0.f;
+	for (const ImVec2& p : legacy.Data) legacyMax = ImMax(legacyMax, p.y);
+	for (int i = 0; i < sweep.Size(); ++i) if (sweep.Y()[i] == sweep.Y()[i]) sweepMax = ImMax(sweepMax, sweep.Y()[i]);
+
+	const double legacyPlotNs = MeasurePlotFrameNs(frames, [&] {
+		ImPlot::PlotLine("legacy", &legacy.Data[0].x, &legacy.Data[0].y, legacy.Data.size(), 0, 0, 2 * sizeof(float));
+	});
+	const double sweepPlotNs = MeasurePlotFrameNs(frames, [&] {
+		PlotSweepLine("sweep", sweep);
+	});
+
+	// a wider span keeps both sweeps, spike included
+	SweepBuffer<float> widened = sweep;
+	widened.SetSpan(2.f * span);
+	float widenedMax = 0.f;
+	for (int i = 0; i < widened.Size(); ++i) if (widened.Y()[i] == widened.Y()[i]) widenedMax = ImMax(widenedMax, widened.Y()[i]);
+
+	printf("{\"buffer\":\"rolling\",\"rate_hz\":%.0f,\"span_s\":%.1f,\"buckets\":%d,"
+		"\"legacy\":{\"points\":%d,\"peak_bytes\":%zu,\"plot_ns_per_frame\":%.0f,\"spike_kept\":%s},"
+		"\"sweep\":{\"points\":%d,\"bytes\":%zu,\"plot_ns_per_frame\":%.0f,\"spike_kept\":%s,\"spike_kept_after_span_change\":%s}}\n",
+		rateHz, span, buckets,
+		legacy.Data.Size, legacyPeak, legacyPlotNs, legacyMax >= 10.f ? "true" : "false",
+		sweep.Size(), (size_t)sweep.Size() * 2 * sizeof(float), sweepPlotNs, sweepMax >= 10.f ? "true" : "false",
+		widenedMax >= 10.f ? "true" : "false");
+}
+
+static void RunIngest(double ingestHz, int queueCapacity) {
+	using Clock = std::chrono::steady_clock;
+	SampleQueue<> queue(queueCapacity);
+	StreamingBuffer<double> channel(20000);
+	std::atomic<bool> stop{ false };
+
+	// paced producer, one sample per period, for one second of frames
+	std::thread producer([&] {
+		const auto period = std::chrono::duration<double>(1.0 / ingestHz);
+		auto next = Clock::now();
+		for (long long i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+			queue.Push({ (double)i / ingestHz, sin((double)i * 0.01) });
+			next += std::chrono::duration_cast<Clock::duration>(period);
+			std::this_thread::sleep_until(next);
+		}
+	});
+	double drainNs = 0.0;
+	int frames = 0;
+	for (auto frameEnd = Clock::now(); frames < 60; ++frames) {
+		frameEnd += std::chrono::microseconds(16667);
+		std::this_thread::sleep_until(frameEnd);
+		const auto t0 = Clock::now();
+		queue.DrainInto(channel);
+		drainNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+	}
+	stop = true;
+	producer.join();
+	queue.DrainInto(channel);
+	const SampleQueueStats paced = queue.GetStats();
+
+	// half-capacity bursts pushed and drained on this thread
+	SampleQueue<> burst(queueCapacity);
+	const int batch = burst.Capacity() / 2;
+	const int rounds = 20000000 / batch;
+	double sink = 0.0, burstPushNs = 0.0, burstDrainNs = 0.0;
+	for (int r = 0; r < rounds; ++r) {
+		const auto t0 = Clock::now();
+		for (int i = 0; i < batch; ++i) burst.Push({ (double)i, (double)r });
+		const auto t1 = Clock::now();
+		burst.Drain([&](const StreamSample* samples, int n) { for (int i = 0; i < n; ++i) sink += samples[i].Y; });
+		const auto t2 = Clock::now();
+		burstPushNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+		burstDrainNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+	}
+	const double samples = (double)rounds * batch;
+
+	printf("{\"buffer\":\"ingest\",\"ingest_hz\":%.0f,\"capacity\":%d,"
+		"\"paced\":{\"pushed\":%llu,\"dropped\":%llu,\"high_water\":%d,\"drain_ns_per_frame\":%.0f},"
+		"\"burst\":{\"push_ns\":%.2f,\"drain_ns\":%.2f,\"checksum\":%.0f}}\n",
+		ingestHz, paced.Capacity,
+		(unsigned long long)paced.Pushed, (unsigned long long)paced.Dropped, paced.HighWater, drainNs / frames,
+		burstPushNs / samples, burstDrainNs / samples, sink);
+}
+
+static void RunPyramid(int samples, int frames) {
+	PyramidChannel<double> channel;
+	std::vector<double> xs(samples);
+	std::vector<double> ys(samples);
+	for (int i = 0; i < samples; ++i) {
+		xs[i] = i * 0.001;
+		ys[i] = sin(i * 0.0007) + ((i % 9973) == 0 ? 3.0 : 0.0);
+	}
+	const double addNs = MeasureNsPerIter(samples, [&](int i) { channel.AddPoint(xs[i], ys[i]); });
+
+	const double full = xs.back();
+	const double zooms[] = { 1.0, 1e-2, 1e-4, 1e-6 };
+	for (double zoom : zooms) {
+		const double xMin = full * 0.5 * (1.0 - zoom), xMax = xMin + full * zoom;
+		PyramidView<double, double> view = channel.Select(xMin, xMax, 1600.f);
+		const double rawNs = MeasurePlotFrameNs(frames, [&] {
+			ImPlot::PlotLine("raw", channel.X(), channel.Y(), channel.Size());
+		}, xMin, xMax);
+		const double pyramidNs = MeasurePlotFrameNs(frames, [&] {
+			PlotPyramidLine("pyramid", channel);
+		}, xMin, xMax);
+		printf("{\"buffer\":\"pyramid\",\"samples\":%d,\"levels\":%d,\"add_ns\":%.1f,\"zoom\":%g,"
+			"\"raw\":{\"points\":%d,\"plot_ns_per_frame\":%.0f},"
+			"\"pyramid\":{\"level\":%d,\"points\":%d,\"plot_ns_per_frame\":%.0f}}\n",
+			samples, channel.LevelCount(), addNs, zoom,
+			channel.Size(), rawNs,
+			view.Level, view.Count, pyramidNs);
+	}
+}
+
+int main(int argc, char** argv) {
+	int points = 20000, frames = 200, buckets = 1024;
+	double hours = 8.0, rate = 1000.0;
+	float span = 10.f;
+	double ingestHz = 1000.0;
+	int queueCapacity = 4096;
+	int recording = 1000000;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (!strcmp(argv[i], "--points")) points = atoi(argv[i + 1]);
+		else if (!strcmp(argv[i], "--frames")) frames = atoi(argv[i + 1]);
+		else if (!strcmp(argv[i], "--hours")) hours = atof(argv[i + 1]);
+		else if (!strcmp(argv[i], "--rate")) rate = atof(argv[i + 1]);
+		else if (!strcmp(argv[i], "--span")) span = (float)atof(argv[i + 1]);
+		else if (!strcmp(argv[i], "--buckets")) buckets = atoi(argv[i + 1]);
+		else if (!strcmp(argv[i], "--ingest-hz")) ingestHz = atof(argv[i + 1]);
+		else if (!strcmp(argv[i], "--queue")) queueCapacity = atoi(argv[i + 1]);
+		else if (!strcmp(argv[i], "--recording")) recording = atoi(argv[i + 1]);
+	}
+
+	ImGui::CreateContext();
+	ImPlot::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920, 1080);
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;   // long lines exceed 64k vertices
+	io.DeltaTime = 1.f / 60.f;
+	unsigned char* pixels; int w, h;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+
+	RunScrolling(points, frames, hours);
+	RunRolling(rate, span, buckets, frames);
+	RunIngest(ingestHz, queueCapacity);
+	RunPyramid(recording, ImMax(frames / 20, 3));
+
+	ImPlot::DestroyContext();
+	ImGui::DestroyContext();
+	return 0;
+}
@@ -1,5 +1,9 @@
 #pragma once
 #include "FrameGUILayout.h"
+#include "FrameGUIStaticLayout.h"
+#include "FrameGUIWorkspaces.h"
+#include "FrameGUIStreamBuffers.h"
+#include "FrameGUISampleQueue.h"
 #include "windows.h"
 #include "imgui.h"
 #include "implot.h"
@@ -8,6 +12,9 @@
 #include <d3d11.h>
 #include <tchar.h>
 #include <cmath> 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,89 +34,114 @@ static void CreateRenderTarget();
 static void CleanupRenderTarget();
 
 
-static void WinLat() {
-    ImGui::Begin("Latitude");
-    ImGui::Text("Lat content"); 
-    ImGui::End();
-}
-static void WinLon() { ImGui::Begin("Longitude"); ImGui::Text("Lon content");  ImGui::End(); }
-static void WinAlt() { ImGui::Begin("Altitude");  ImGui::Text("Alt content");  ImGui::End(); }
-static void WinYaw() { ImGui::Begin("Yaw");       ImGui::Text("Yaw content");  ImGui::End(); }
-static void WinPitch() { ImGui::Begin("Pitch");     ImGui::Text("Pitch content"); ImGui::End(); }
-static void WinRoll() { ImGui::Begin("Roll");      ImGui::Text("Roll content"); ImGui::End(); }
-static void RealtimePlots() {
-    ImGui::Begin("realtime Plot");
-    ImVec2 avail_size = ImGui::GetContentRegionAvail();
-    float plot_height = avail_size.y * 0.5f;
-    ImGui::BulletText("Move your mouse to change the data!");
-    //ImGui::BulletText("This example assumes 60 FPS. Higher FPS requires larger buffer size.");
-    static FrameGUILayout::ScrollingBuffer sdata1, sdata2;
-    static FrameGUILayout::RollingBuffer   rdata1, rdata2;
-    ImVec2 mouse = ImGui::GetMousePos();
-    static float t = 0;
-    t += ImGui::GetIO().DeltaTime;
-    sdata1.AddPoint(t, mouse.x * 0.0005f);
-    rdata1.AddPoint(t, mouse.x * 0.0005f);
-    sdata2.AddPoint(t, mouse.y * 0.0005f);
-    rdata2.AddPoint(t, mouse.y * 0.0005f);
-
-    static float history = 10.0f;
-    ImGui::SliderFloat("History", &history, 1, 30, "%.1f s");
-    rdata1.Span = history;
-    rdata2.Span = history;
-
-    static ImPlotAxisFlags flags = ImPlotAxisFlags_NoTickLabels;
-
-    if (ImPlot::BeginPlot("##Scrolling", ImVec2(-1, plot_height))) {
-        ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-        ImPlot::SetupAxisLimits(ImAxis_X1, t - history, t, ImGuiCond_Always);
-        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-        ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
-        
-        ImPlot::PlotShaded("Mouse X", 
-                          &sdata1.Data[0].x, &sdata1.Data[0].y, 
-                          sdata1.Data.size(), 
-                          -INFINITY, 
-                          0,  
-                          sdata1.Offset, 
-                          2 * sizeof(float));
-        
-
-        ImPlot::PlotLine("Mouse Y", 
-                        &sdata2.Data[0].x, &sdata2.Data[0].y, 
-                        sdata2.Data.size(), 
-                        0,  
-                        sdata2.Offset, 
-                        2 * sizeof(float));
-        
-        ImPlot::EndPlot();
+// Panes are plain functors: their state lives inline in the layout node, so
+// the same pane type can be instantiated any number of times.
+struct TextPane {
+    const char* Title;
+    const char* Text;
+    void operator()() const {
+        ImGui::Begin(Title);
+        ImGui::TextUnformatted(Text);
+        ImGui::End();
     }
-    
+};
 
-    if (ImPlot::BeginPlot("##Rolling", ImVec2(-1, -1))) {
-        ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
-        ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
-        
-
-        ImPlot::PlotLine("Mouse X", 
-                        &rdata1.Data[0].x, &rdata1.Data[0].y, 
-                        rdata1.Data.size(), 
-                        0,  
-                        0,  
-                        2 * sizeof(float));
-        
-        ImPlot::PlotLine("Mouse Y", 
-                        &rdata2.Data[0].x, &rdata2.Data[0].y, 
-                        rdata2.Data.size(), 
-                        0,  
-                        0,  
-                        2 * sizeof(float));
-        
-        ImPlot::EndPlot();
+struct RealtimePlotPane {
+    const char* Title = "realtime Plot";
+    FrameGUILayout::StreamingBuffer<double> sdata1, sdata2;
+    FrameGUILayout::SweepBuffer<float> rdata1, rdata2;
+    double t = 0;
+    float history = 10.0f;
+    ImPlotAxisFlags flags = ImPlotAxisFlags_NoTickLabels;
+
+    // called by the layout once the pane has been hidden for a while
+    size_t Compact() {
+        return sdata1.Release() + sdata2.Release() + rdata1.Release() + rdata2.Release();
     }
-    ImGui::End();
-}
+
+    void operator()() {
+        ImGui::Begin(Title);
+        ImVec2 avail_size = ImGui::GetContentRegionAvail();
+        float plot_height = avail_size.y * 0.5f;
+        ImGui::BulletText("Move your mouse to change the data!");
+        //ImGui::BulletText("This example assumes 60 FPS. Higher FPS requires larger buffer size.");
+        ImVec2 mouse = ImGui::GetMousePos();
+        t += ImGui::GetIO().DeltaTime;
+        sdata1.AddPoint(t, mouse.x * 0.0005f);
+        rdata1.AddPoint(t, mouse.x * 0.0005f);
+        sdata2.AddPoint(t, mouse.y * 0.0005f);
+        rdata2.AddPoint(t, mouse.y * 0.0005f);
+
+        ImGui::SliderFloat("History", &history, 1, 30, "%.1f s");
+        // rebucketing on every slider step would blur the sweep, so it waits for the release
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            rdata1.SetSpan(history);
+            rdata2.SetSpan(history);
+        }
+
+        if (ImPlot::BeginPlot("##Scrolling", ImVec2(-1, plot_height))) {
+            ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
+            ImPlot::SetupAxisLimits(ImAxis_X1, t - history, t, ImGuiCond_Always);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
+            ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
+
+            FrameGUILayout::PlotStreamShaded("Mouse X", sdata1, -INFINITY);
+            FrameGUILayout::PlotStreamLine("Mouse Y", sdata2);
+
+            ImPlot::EndPlot();
+        }
+
+
+        if (ImPlot::BeginPlot("##Rolling", ImVec2(-1, -1))) {
+            ImPlot::SetupAxes(nullptr, nullptr, flags, flags);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, rdata1.GetSpan(), ImGuiCond_Always);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
+
+
+            FrameGUILayout::PlotSweepLine("Mouse X", rdata1);
+            FrameGUILayout::PlotSweepLine("Mouse Y", rdata2);
+
+            ImPlot::EndPlot();
+        }
+        ImGui::End();
+    }
+};
+
+// Fed by an acquisition thread: Prepare drains everything queued since the
+// last frame before the panes are submitted, operator() only plots.
+struct TelemetryPane {
+    FrameGUILayout::SampleQueue<>* Queue;
+    FrameGUILayout::StreamingBuffer<double> Signal{ 20000 };
+
+    void Prepare(float, const ImRect&) { Queue->DrainInto(Signal); }
+    size_t Compact() { return Signal.Release(); }
+
+    void operator()() {
+        ImGui::Begin("Telemetry");
+        const FrameGUILayout::SampleQueueStats stats = Queue->GetStats();
+        ImGui::Text("%llu samples, %llu dropped, high water %d/%d", (unsigned long long)stats.Pushed, (unsigned long long)stats.Dropped, stats.HighWater, stats.Capacity);
+        if (ImPlot::BeginPlot("##Telemetry", ImVec2(-1, -1))) {
+            const double now = Signal.Empty() ? 0.0 : Signal.BackX();
+            ImPlot::SetupAxisLimits(ImAxis_X1, now - 10.0, now, ImGuiCond_Always);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, -1.2, 1.2);
+            FrameGUILayout::PlotStreamLine("1 kHz", Signal);
+            ImPlot::EndPlot();
+        }
+        ImGui::End();
+    }
+};
+
+// A layout whose shape is fixed at compile time: the description is checked
+// by static_asserts and built into a runtime tree for the Attitude workspace.
+static void YawStrip() { ImGui::Begin("Yaw##strip"); ImGui::TextUnformatted("Yaw content"); ImGui::End(); }
+static void PitchStrip() { ImGui::Begin("Pitch##strip"); ImGui::TextUnformatted("Pitch content"); ImGui::End(); }
+static void RollStrip() { ImGui::Begin("Roll##strip"); ImGui::TextUnformatted("Roll content"); ImGui::End(); }
+static constexpr char YawLabel[] = "Yaw";
+static constexpr char PitchLabel[] = "Pitch";
+static constexpr char RollLabel[] = "Roll";
+using AttitudeStrip = FrameGUILayout::HSplit<
+    FrameGUILayout::VSplit<FrameGUILayout::Pane<&YawStrip, YawLabel>, FrameGUILayout::Pane<&PitchStrip, PitchLabel>>,
+    FrameGUILayout::Pane<&RollStrip, RollLabel>>;
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
 {
@@ -131,29 +163,66 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
 
 
     auto* row0 = new FrameGUILayout::CustomLayoutNode(true, "Geodetic");
-    row0->SetVerticalChildren(
-        new FrameGUILayout::CustomLayoutNode(&WinLat, "Latitude"),
-        new FrameGUILayout::CustomLayoutNode(&WinLon, "Longitude"),
-        new FrameGUILayout::CustomLayoutNode(&WinAlt, "Altitude")
-    );
+    row0->SetVerticalChildren({
+        new FrameGUILayout::CustomLayoutNode(TextPane{ "Latitude", "Lat content" }, "Latitude"),
+        new FrameGUILayout::CustomLayoutNode(TextPane{ "Longitude", "Lon content" }, "Longitude"),
+        new FrameGUILayout::CustomLayoutNode(TextPane{ "Altitude", "Alt content" }, "Altitude")
+    });
 
    
-    auto* row1 = new FrameGUILayout::CustomLayoutNode(true, "Attitude");
-    row1->SetVerticalChildren(
-        new FrameGUILayout::CustomLayoutNode(&WinYaw, "Yaw"),
-        new FrameGUILayout::CustomLayoutNode(&WinPitch, "Pitch"),
-        new FrameGUILayout::CustomLayoutNode(&WinRoll, "Roll")
-    );
+    // one attitude angle at a time; the other two are not run at all
+    auto* row1 = new FrameGUILayout::CustomLayoutNode(FrameGUILayout::LayoutNode_Tabs, "Attitude");
+    row1->AddTab(new FrameGUILayout::CustomLayoutNode(TextPane{ "Yaw", "Yaw content" }, "Yaw"));
+    row1->AddTab(new FrameGUILayout::CustomLayoutNode(TextPane{ "Pitch", "Pitch content" }, "Pitch"));
+    row1->AddTab(new FrameGUILayout::CustomLayoutNode(TextPane{ "Roll", "Roll content" }, "Roll"));
 
 
     auto* row2 = new FrameGUILayout::CustomLayoutNode(true, "relplot");
-    row2->SetVerticalChildren(new FrameGUILayout::CustomLayoutNode(&RealtimePlots, "rel"));
+    row2->SetVerticalChildren({ new FrameGUILayout::CustomLayoutNode(RealtimePlotPane{}, "rel") });
+
+    // static text panes only need to be re-run when invalidated
+    for (auto* pane : row0->GetChildren()) pane->SetRefreshPolicy(FrameGUILayout::PaneRefresh_OnInvalidate);
+    for (auto* pane : row1->GetChildren()) pane->SetRefreshPolicy(FrameGUILayout::PaneRefresh_OnInvalidate);
+
+    // pixel limits hold at any window size; the plot column never drops below 320px
+    for (auto* pane : row0->GetChildren()) pane->SetSizeConstraints(40.f);
+    row2->SetSizeConstraints(320.f);
 
     root->AddHorizontalChild(row0);
     root->AddHorizontalChild(row1);
     root->AddHorizontalChild(row2);
 
-    FrameGUILayout::CustomLayout layout(root);
+    auto* overview = new FrameGUILayout::CustomLayout(root);
+    overview->EnableIniSettings("Main");
+
+    // a second workspace with the plot on its own; switching between the two
+    // keeps both layouts warm
+    RealtimePlotPane fullPlot;
+    fullPlot.Title = "realtime Plot##full";
+    // a 1 kHz acquisition thread; it never waits for the UI
+    FrameGUILayout::SampleQueue<> telemetry(4096);
+    std::atomic<bool> acquiring{ true };
+    std::thread acquisition([&] {
+        const auto start = std::chrono::steady_clock::now();
+        long long sent = 0;
+        while (acquiring.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            const long long due = (long long)(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0);
+            for (; sent < due; ++sent) telemetry.Push({ sent * 0.001, sin(sent * 0.002 * 3.14159265) });
+        }
+    });
+
+    auto* plotRoot = new FrameGUILayout::CustomLayoutNode(false, "PlotRoot");
+    plotRoot->SetHorizontalChildren({
+        new FrameGUILayout::CustomLayoutNode(fullPlot, "full"),
+        new FrameGUILayout::CustomLayoutNode(TelemetryPane{ &telemetry }, "Telemetry")
+    });
+
+    FrameGUILayout::WorkspaceManager workspaces;
+    workspaces.Add("Overview", overview);
+    workspaces.Add("Realtime", new FrameGUILayout::CustomLayout(plotRoot));
+    workspaces.Add("Attitude", new FrameGUILayout::CustomLayout(FrameGUILayout::BuildNodeTree<AttitudeStrip>()));
+    workspaces.SetIdleReleaseDelay(10.f);
 
     bool done = false;
     while (!done) {
@@ -161,7 +230,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
         if (done) break;
         ImGui_ImplDX11_NewFrame(); ImGui_ImplWin32_NewFrame(); ImGui::NewFrame();
 
-        layout.UpdateAndRender();
+        workspaces.UpdateAndRender();
 
         ImGui::Render();
         const float clear_color_with_alpha[4] = { 0.1f, 0.1f, 0.1f, 1.00f };
@@ -170,6 +239,8 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
         ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
         g_pSwapChain->Present(1, 0);
     }
+    acquiring = false;
+    acquisition.join();
     ImPlot::DestroyContext();
     ImGui_ImplDX11_Shutdown(); 
     ImGui_ImplWin32_Shutdown();
@@ -0,0 +1,66 @@
+// Converts save/frame_data_*.json sessions into the columnar recording format
+// read by FrameRecording. Each input is written next to itself with the
+// .json extension replaced by .fgrec (or to the given path with -o when there
+// is one input), mapped back and checked, and one JSON object per file is
+// printed with the frame count, both file sizes and the convert/open times:
+//
+//   RecordingConvert [-o out.fgrec] session.json...
+#include "FrameGUIRecording.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace FrameGUILayout;
+
+static long FileBytes(const char* path) {
+	FILE* f = fopen(path, "rb");
+	if (!f) return -1;
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+static std::string OutputPath(const std::string& input) {
+	const size_t ext = input.size() >= 5 ? input.rfind(".json") : std::string::npos;
+	return (ext != std::string::npos && ext == input.size() - 5 ? input.substr(0, ext) : input) + ".fgrec";
+}
+
+int main(int argc, char** argv) {
+	const char* output = nullptr;
+	std::vector<const char*> inputs;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) output = argv[++i];
+		else inputs.push_back(argv[i]);
+	}
+	if (inputs.empty() || (output && inputs.size() != 1)) {
+		fprintf(stderr, "usage: %s [-o out.fgrec] session.json...\n", argv[0]);
+		return 2;
+	}
+
+	int failures = 0;
+	for (const char* input : inputs) {
+		const std::string out = output ? std::string(output) : OutputPath(input);
+		auto t0 = std::chrono::steady_clock::now();
+		if (!FrameRecording::ConvertJsonFile(input, out.c_str())) {
+			fprintf(stderr, "%s: not a readable frame session, or its frames are out of order\n", input);
+			++failures;
+			continue;
+		}
+		auto t1 = std::chrono::steady_clock::now();
+		FrameRecording recording;
+		const bool opened = recording.Open(out.c_str());
+		auto t2 = std::chrono::steady_clock::now();
+		if (!opened) {
+			fprintf(stderr, "%s: written recording does not open\n", out.c_str());
+			++failures;
+			continue;
+		}
+		printf("{\"input\":\"%s\",\"output\":\"%s\",\"frames\":%d,\"blocks\":%d,\"json_bytes\":%ld,\"recording_bytes\":%ld,\"convert_ms\":%.2f,\"open_us\":%.1f}\n",
+			input, out.c_str(), recording.FrameCount(), recording.BlockCount(), FileBytes(input), FileBytes(out.c_str()),
+			std::chrono::duration<double, std::milli>(t1 - t0).count(), std::chrono::duration<double, std::micro>(t2 - t1).count());
+	}
+	return failures == 0 ? 0 : 1;
+}